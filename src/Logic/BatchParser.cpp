@@ -0,0 +1,158 @@
+#include "Global.h"
+#include "BatchParser.h"
+#include "Rubik.h"
+
+BatchParser::BatchParser(const char* data, size_t size)
+{
+    m_data = data;
+    m_end = data + size;
+    m_pos = data;
+    m_line = 0;
+    m_cubeLine = 0;
+}
+
+bool BatchParser::NextLine(const char* &line, size_t &length)
+{
+    while (m_pos < m_end)
+    {
+        line = m_pos;
+        const char* end = (const char*)memchr(m_pos, '\n', m_end - m_pos);
+        if (!end)
+            end = m_end;
+
+        m_pos = (end < m_end) ? end + 1 : m_end;
+        m_line++;
+
+        // files written on Windows keep carriage return at the end of line
+        if (end > line && end[-1] == '\r')
+            end--;
+
+        length = (size_t)(end - line);
+        if (length > 0 && line[0] != '#')
+            return true;
+    }
+
+    return false;
+}
+
+// faces of facelet string in their order, and color codes of cube net used for them (any distinct colors would do,
+// the faces of net are given by colors of centers)
+static const char faceletFaces[] = "URFDLB";
+static const char faceletColors[] = "RYGWBO";
+
+// is the line facelet string? (exactly FACELET_STRING_LENGTH face letters)
+static bool isFaceletString(const char* line, size_t length)
+{
+    if (length != FACELET_STRING_LENGTH)
+        return false;
+
+    for (size_t i = 0; i < length; i++)
+        if (!memchr(faceletFaces, line[i], 6))
+            return false;
+
+    return true;
+}
+
+// copies one row of face (3 facelets) as color codes of cube net
+static void copyFaceletRow(char* dst, const char* facelets)
+{
+    for (int i = 0; i < 3; i++)
+        dst[i] = faceletColors[(const char*)memchr(faceletFaces, facelets[i], 6) - faceletFaces];
+}
+
+// lays facelet string out as lines of cube net, so it could be parsed the same way as the net
+static void faceletsToNet(const char* facelets, char rows[9][12], size_t lengths[9])
+{
+    const char* up = facelets;
+    const char* right = facelets + 9;
+    const char* front = facelets + 18;
+    const char* down = facelets + 27;
+    const char* left = facelets + 36;
+    const char* back = facelets + 45;
+
+    for (int i = 0; i < 3; i++)
+    {
+        memset(rows[i], ' ', 3);
+        copyFaceletRow(rows[i] + 3, up + 3 * i);
+        lengths[i] = 6;
+
+        copyFaceletRow(rows[i + 3], left + 3 * i);
+        copyFaceletRow(rows[i + 3] + 3, front + 3 * i);
+        copyFaceletRow(rows[i + 3] + 6, right + 3 * i);
+        copyFaceletRow(rows[i + 3] + 9, back + 3 * i);
+        lengths[i + 3] = 12;
+
+        memset(rows[i + 6], ' ', 3);
+        copyFaceletRow(rows[i + 6] + 3, down + 3 * i);
+        lengths[i + 6] = 6;
+    }
+}
+
+// the net is recognized by indented upper side, scramble by flip notation, facelet string by its length and face
+// letters, everything else is taken as permutation string
+bool BatchParser::Next(CubeState &state, SolveResult &result)
+{
+    const char* lines[9];
+    size_t lengths[9];
+
+    if (!NextLine(lines[0], lengths[0]))
+        return false;
+
+    m_cubeLine = m_line;
+    m_error.clear();
+
+    if (lengths[0] >= 3 && lines[0][0] == ' ' && lines[0][1] == ' ' && lines[0][2] == ' ')
+    {
+        int count = 1;
+        while (count < 9 && NextLine(lines[count], lengths[count]))
+            count++;
+
+        RubikColor net[CF_COUNT][3][3];
+        if (count < 9)
+        {
+            m_error = "Incomplete cube net at the end of input";
+            result = SOLVE_INVALID_CUBIE;
+        }
+        else if (!RubikCube::ParseNet(lines, lengths, net, m_error))
+            result = SOLVE_INVALID_CUBIE;
+        else
+            result = RubikCube::GetNetState(net, state);
+    }
+    // scramble is recognized by the second character of its first flip, cubie names consist of face letters only
+    else if (lengths[0] >= 2 && (lines[0][1] == '+' || lines[0][1] == '2' || lines[0][1] == '-'))
+    {
+        // every scramble gives valid state, so there's nothing to validate
+        if (state.FromScramble(lines[0], lengths[0]))
+            result = SOLVE_OK;
+        else
+        {
+            m_error = "Unknown flip in scramble";
+            result = SOLVE_INVALID_CUBIE;
+        }
+    }
+    else if (isFaceletString(lines[0], lengths[0]))
+    {
+        const char* facelets = lines[0];
+        char rows[9][12];
+        faceletsToNet(facelets, rows, lengths);
+        for (int i = 0; i < 9; i++)
+            lines[i] = rows[i];
+
+        // the net could only fail on counts of colors, which would be reported by color codes of the net
+        RubikColor net[CF_COUNT][3][3];
+        if (!RubikCube::ParseNet(lines, lengths, net, m_error))
+        {
+            m_error = "Invalid facelet string - every face letter has to be used 9 times, once as center";
+            result = SOLVE_INVALID_CUBIE;
+        }
+        else
+            result = RubikCube::GetNetState(net, state);
+    }
+    else
+        result = state.FromString(lines[0], lengths[0]) ? state.Validate() : SOLVE_INVALID_CUBIE;
+
+    if (result != SOLVE_OK && m_error.empty())
+        m_error = std::string("Invalid cube - ") + getSolveResultStr(result);
+
+    return true;
+}
@@ -0,0 +1,48 @@
+#ifndef RUBIK_BATCHPARSER_H
+#define RUBIK_BATCHPARSER_H
+
+#include "CubeState.h"
+
+// length of facelet string - 9 facelets of every face, the faces in order U, R, F, D, L, B, every face row by row
+// as seen in cube net (see RubikCube::LoadFromFile), every facelet given by letter of face, where its color belongs
+#define FACELET_STRING_LENGTH 54
+
+// parser of batch of cubes - cube nets (9 lines, see RubikCube::LoadFromFile), facelet strings (one line, see
+// FACELET_STRING_LENGTH), permutation strings (one line of cubie names, as written by generator) and scrambles
+// (one line of flips, see CubeState::FromScramble) in any order; it works directly on bytes of input, no line is
+// copied, so it's meant to run over memory mapped file
+class BatchParser
+{
+    public:
+        BatchParser(const char* data, size_t size);
+
+        // parses next cube into state, with result of parsing and validation in result; returns false at the end
+        // of input
+        bool Next(CubeState &state, SolveResult &result);
+
+        // line of input, where the last cube starts (counted from 1)
+        unsigned long long GetLine() const { return m_cubeLine; };
+        // reason, why the last cube is not valid
+        std::string const& GetError() const { return m_error; };
+        // count of bytes parsed so far
+        size_t GetPosition() const { return (size_t)(m_pos - m_data); };
+
+    private:
+        // finds next line, which is not empty nor comment (without line terminator); returns false at the end
+        // of input
+        bool NextLine(const char* &line, size_t &length);
+
+        // input
+        const char* m_data;
+        const char* m_end;
+        // start of next line
+        const char* m_pos;
+        // number of the last line found
+        unsigned long long m_line;
+        // number of line, where the last cube starts
+        unsigned long long m_cubeLine;
+        // error of the last cube
+        std::string m_error;
+};
+
+#endif
@@ -0,0 +1,408 @@
+#include "Global.h"
+#include "CubeState.h"
+
+// for every flip and every position, this contains position, from which the cubie comes
+static unsigned char flipSource[FLIP_MAX][STATE_STRING_LENGTH];
+// for every flip and every position, this contains orientation change of incoming cubie
+static unsigned char flipTwist[FLIP_MAX][STATE_STRING_LENGTH];
+
+// modulo 3 lookup (corner orientation could reach at most 2 + 2)
+static const unsigned char mod3[] = { 0, 1, 2, 0, 1, 2 };
+
+// builds flip tables at startup - the flips are composed from quarter turns the same way as
+// RubikCube::DoLinearFlip does it, so both representations behave exactly the same
+static struct FlipTableBuilder
+{
+    FlipTableBuilder()
+    {
+        for (int move = 0; move < FLIP_MAX; move++)
+        {
+            int turns = move % 3 + 1;
+            int face = move / 3;
+            CubeFlip flip = getFlipForLinearMove(move);
+
+            unsigned char source[STATE_STRING_LENGTH], twist[STATE_STRING_LENGTH];
+            for (int i = 0; i < STATE_STRING_LENGTH; i++)
+            {
+                source[i] = (unsigned char)i;
+                twist[i] = 0;
+            }
+
+            while (turns--)
+            {
+                unsigned char oldSource[STATE_STRING_LENGTH], oldTwist[STATE_STRING_LENGTH];
+                memcpy(oldSource, source, sizeof(source));
+                memcpy(oldTwist, twist, sizeof(twist));
+
+                for (int i = 0; i < 8; i++)
+                {
+                    int isCorner = i > 3;
+                    int target = flipCubeEffect[face][i] + isCorner * 12;
+                    int from = flipCubeEffect[face][(i & 3) == 3 ? i - 3 : i + 1] + isCorner * 12;
+                    int orientationDelta = isCorner ? ((face < 2) ? 0 : (2 - (i & 1))) : (face > 1 && face < 4);
+
+                    source[target] = oldSource[from];
+                    twist[target] = (unsigned char)((oldTwist[from] + orientationDelta) % (2 + isCorner));
+                }
+            }
+
+            memcpy(flipSource[flip], source, sizeof(source));
+            memcpy(flipTwist[flip], twist, sizeof(twist));
+        }
+    }
+} flipTableBuilder;
+
+// number of face letter (-1 = not a face)
+static int getFaceNumber(char c)
+{
+    switch (c)
+    {
+        case 'U': return 0;
+        case 'D': return 1;
+        case 'F': return 2;
+        case 'B': return 3;
+        case 'R': return 4;
+        case 'L': return 5;
+        default:  return -1;
+    }
+}
+
+// first flip of every face (indexed by face number, see getFaceNumber) - the flips of face follow in order of
+// CubeFlip enumerator
+static const unsigned char faceFlipGroup[] = { FLIP_U_P, FLIP_D_P, FLIP_F_P, FLIP_B_P, FLIP_R_P, FLIP_L_P };
+
+// offset of flip within its group by the second character of flip string (-1 = not a flip)
+static int getFlipOffset(char c)
+{
+    switch (c)
+    {
+        case '+': return 0;
+        case '2': return 1;
+        case '-': return 2;
+        default:  return -1;
+    }
+}
+
+// cubie and its orientation for every name of edge (6 x 6 face letters) and corner (6 x 6 x 6), so the parser
+// does not have to rotate the names and look them up (0xFF = no such cubie)
+static unsigned char edgeNameCubie[6 * 6], edgeNameOrient[6 * 6];
+static unsigned char cornerNameCubie[6 * 6 * 6], cornerNameOrient[6 * 6 * 6];
+
+// builds cubie name tables at startup - the name rotated left by orientation has to give solved name (the same
+// way as FromString used to look it up)
+static struct CubieNameTableBuilder
+{
+    CubieNameTableBuilder()
+    {
+        memset(edgeNameCubie, 0xFF, sizeof(edgeNameCubie));
+        memset(cornerNameCubie, 0xFF, sizeof(cornerNameCubie));
+
+        for (int i = 0; i < STATE_STRING_LENGTH; i++)
+        {
+            std::string const& name = solvedPermutation[i];
+            int len = (int)name.length();
+
+            for (int rotation = 0; rotation < len; rotation++)
+            {
+                int key = 0;
+                for (int k = 0; k < len; k++)
+                    key = key * 6 + getFaceNumber(name[(k - rotation + len) % len]);
+
+                if (len == 2)
+                {
+                    edgeNameCubie[key] = (unsigned char)i;
+                    edgeNameOrient[key] = (unsigned char)rotation;
+                }
+                else
+                {
+                    cornerNameCubie[key] = (unsigned char)i;
+                    cornerNameOrient[key] = (unsigned char)rotation;
+                }
+            }
+        }
+    }
+} cubieNameTableBuilder;
+
+void CubeState::SetSolved()
+{
+    for (int i = 0; i < STATE_STRING_LENGTH; i++)
+    {
+        perm[i] = (unsigned char)i;
+        orient[i] = 0;
+    }
+}
+
+bool CubeState::IsSolved() const
+{
+    for (int i = 0; i < STATE_STRING_LENGTH; i++)
+        if (perm[i] != i || orient[i] != 0)
+            return false;
+    return true;
+}
+
+// the state is reachable from solved cube, if every cubie is present exactly once, sum of edge orientations is even,
+// sum of corner orientations is divisible by 3, and edge and corner permutations have the same parity
+SolveResult CubeState::Validate() const
+{
+    int seen = 0;
+    int edgeSum = 0, cornerSum = 0;
+
+    for (int i = 0; i < STATE_STRING_LENGTH; i++)
+    {
+        bool isCorner = i >= STATE_EDGE_COUNT;
+
+        // edge has to be on edge position, and corner on corner position, with valid orientation
+        if (perm[i] >= STATE_STRING_LENGTH || (perm[i] >= STATE_EDGE_COUNT) != isCorner || orient[i] >= (isCorner ? 3 : 2))
+            return SOLVE_INVALID_CUBIE;
+
+        if (seen & (1 << perm[i]))
+            return SOLVE_DUPLICATE_CUBIE;
+        seen |= 1 << perm[i];
+
+        if (isCorner)
+            cornerSum += orient[i];
+        else
+            edgeSum += orient[i];
+    }
+
+    if (edgeSum % 2 != 0)
+        return SOLVE_EDGE_FLIP;
+
+    if (cornerSum % 3 != 0)
+        return SOLVE_CORNER_TWIST;
+
+    // parity of permutation - every cycle of length n consists of n-1 transpositions
+    int parity = 0;
+    int visited = 0;
+    for (int i = 0; i < STATE_STRING_LENGTH; i++)
+    {
+        if (visited & (1 << i))
+            continue;
+
+        int length = 0;
+        for (int j = i; !(visited & (1 << j)); j = perm[j])
+        {
+            visited |= 1 << j;
+            length++;
+        }
+        parity ^= (length - 1) & 1;
+    }
+
+    // edges and corners do not mix, so the parity of whole permutation is sum of both parities - and they must match
+    if (parity != 0)
+        return SOLVE_PARITY;
+
+    return SOLVE_OK;
+}
+
+// only the 8 cubies of turned face move (see flipCubeEffect), the others are left as they are
+void CubeState::DoFlip(CubeFlip flip)
+{
+    const unsigned char* source = flipSource[flip];
+    const unsigned char* twist = flipTwist[flip];
+    const int* affected = flipCubeEffect[5 - flip / 3];
+
+    unsigned char oldPerm[STATE_STRING_LENGTH], oldOrient[STATE_STRING_LENGTH];
+    int i;
+    for (i = 0; i < 4; i++)
+    {
+        oldPerm[affected[i]] = perm[affected[i]];
+        oldOrient[affected[i]] = orient[affected[i]];
+        oldPerm[affected[i + 4] + STATE_EDGE_COUNT] = perm[affected[i + 4] + STATE_EDGE_COUNT];
+        oldOrient[affected[i + 4] + STATE_EDGE_COUNT] = orient[affected[i + 4] + STATE_EDGE_COUNT];
+    }
+
+    for (i = 0; i < 4; i++)
+    {
+        int pos = affected[i];
+        perm[pos] = oldPerm[source[pos]];
+        orient[pos] = (oldOrient[source[pos]] + twist[pos]) & 1;
+
+        pos = affected[i + 4] + STATE_EDGE_COUNT;
+        perm[pos] = oldPerm[source[pos]];
+        orient[pos] = mod3[oldOrient[source[pos]] + twist[pos]];
+    }
+}
+
+void CubeState::DoFlips(FlipSequence const& flips)
+{
+    for (FlipSequence::const_iterator itr = flips.begin(); itr != flips.end(); ++itr)
+        DoFlip(*itr);
+}
+
+// the state is uniformly random, when the permutations and orientations are uniformly random, and they
+// satisfy invariants of Rubik's cube - permutation parity of edges and corners match, sum of edge orientations
+// is even and sum of corner orientations is divisible by 3
+void CubeState::Randomize(Random &rng)
+{
+    SetSolved();
+
+    // Fisher-Yates shuffle of edges and corners, count swaps to know parity of both permutations
+    int edgeParity = 0, cornerParity = 0;
+    for (int i = STATE_EDGE_COUNT - 1; i > 0; i--)
+    {
+        int j = rng.NextUInt(i + 1);
+        if (j != i)
+        {
+            swap(perm[i], perm[j]);
+            edgeParity ^= 1;
+        }
+    }
+    for (int i = STATE_CORNER_COUNT - 1; i > 0; i--)
+    {
+        int j = rng.NextUInt(i + 1);
+        if (j != i)
+        {
+            swap(perm[STATE_EDGE_COUNT + i], perm[STATE_EDGE_COUNT + j]);
+            cornerParity ^= 1;
+        }
+    }
+
+    // fix parity by swapping two edges - it maps odd permutations to even ones (and vice versa) one to one,
+    // so the distribution stays uniform
+    if (edgeParity != cornerParity)
+        swap(perm[0], perm[1]);
+
+    // orientations - the last one of each type is determined by the rest
+    int edgeSum = 0, cornerSum = 0;
+    for (int i = 0; i < STATE_EDGE_COUNT - 1; i++)
+    {
+        orient[i] = (unsigned char)rng.NextUInt(2);
+        edgeSum += orient[i];
+    }
+    orient[STATE_EDGE_COUNT - 1] = (unsigned char)(edgeSum & 1);
+
+    for (int i = STATE_EDGE_COUNT; i < STATE_STRING_LENGTH - 1; i++)
+    {
+        orient[i] = (unsigned char)rng.NextUInt(3);
+        cornerSum += orient[i];
+    }
+    orient[STATE_STRING_LENGTH - 1] = (unsigned char)((3 - cornerSum % 3) % 3);
+}
+
+void CubeState::ToLinear(bigint &dst) const
+{
+    dst.size = 2 * STATE_STRING_LENGTH;
+    for (int i = 0; i < STATE_STRING_LENGTH; i++)
+    {
+        dst.d[i] = perm[i];
+        dst.d[i + STATE_STRING_LENGTH] = orient[i];
+    }
+}
+
+void CubeState::FromLinear(bigint const& src)
+{
+    for (int i = 0; i < STATE_STRING_LENGTH; i++)
+    {
+        perm[i] = (unsigned char)src.d[i];
+        orient[i] = (unsigned char)src.d[i + STATE_STRING_LENGTH];
+    }
+}
+
+// cubie name at position is the name of cubie rotated "orientation" times to the right
+// (rotating it back to the left gives the cubie name, see RubikCube::Solve)
+int CubeState::WriteString(char* dst) const
+{
+    char* ptr = dst;
+    for (int i = 0; i < STATE_STRING_LENGTH; i++)
+    {
+        const std::string &name = solvedPermutation[perm[i]];
+        int len = (int)name.length();
+
+        if (i > 0)
+            *ptr++ = ' ';
+        for (int j = 0; j < len; j++)
+            *ptr++ = name[(j - orient[i] + len) % len];
+    }
+    return (int)(ptr - dst);
+}
+
+std::string CubeState::ToString() const
+{
+    char buf[STATE_TEXT_LENGTH];
+    int len = WriteString(buf);
+    return std::string(buf, len);
+}
+
+bool CubeState::FromString(std::string const& str)
+{
+    return FromString(str.c_str(), str.length());
+}
+
+bool CubeState::FromString(const char* str, size_t length)
+{
+    size_t pos = 0;
+    for (int i = 0; i < STATE_STRING_LENGTH; i++)
+    {
+        // skip separators
+        while (pos < length && (str[pos] == ' ' || str[pos] == '\t' || str[pos] == ','))
+            pos++;
+
+        size_t len = (i < STATE_EDGE_COUNT) ? 2 : 3;
+        if (pos + len > length)
+            return false;
+
+        // the name is looked up by its face letters (see CubieNameTableBuilder)
+        int key = 0;
+        for (size_t k = 0; k < len; k++)
+        {
+            int face = getFaceNumber(str[pos + k]);
+            if (face < 0)
+                return false;
+            key = key * 6 + face;
+        }
+        pos += len;
+
+        unsigned char cubie = (len == 2) ? edgeNameCubie[key] : cornerNameCubie[key];
+        if (cubie == 0xFF)
+            return false;
+
+        perm[i] = cubie;
+        orient[i] = (len == 2) ? edgeNameOrient[key] : cornerNameOrient[key];
+    }
+
+    // there should be nothing left except whitespaces
+    while (pos < length)
+    {
+        if (str[pos] != ' ' && str[pos] != '\t' && str[pos] != '\r' && str[pos] != '\n')
+            return false;
+        pos++;
+    }
+
+    return true;
+}
+
+bool CubeState::FromScramble(const char* str, size_t length)
+{
+    SetSolved();
+    return DoFlips(str, length);
+}
+
+// the flips are applied directly to cubies as they are parsed, so there's no flip sequence in between
+bool CubeState::DoFlips(const char* str, size_t length)
+{
+    size_t pos = 0;
+    while (pos < length)
+    {
+        char c = str[pos];
+        if (c == ' ' || c == '\t' || c == ',' || c == '\r' || c == '\n')
+        {
+            pos++;
+            continue;
+        }
+
+        // every flip is exactly two characters long, followed by separator or end of string
+        if (pos + 1 >= length || (pos + 2 < length && str[pos + 2] != ' ' && str[pos + 2] != '\t' && str[pos + 2] != ',' && str[pos + 2] != '\r' && str[pos + 2] != '\n'))
+            return false;
+
+        int face = getFaceNumber(c);
+        int offset = getFlipOffset(str[pos + 1]);
+        if (face < 0 || offset < 0)
+            return false;
+
+        DoFlip((CubeFlip)(faceFlipGroup[face] + offset));
+        pos += 2;
+    }
+
+    return true;
+}
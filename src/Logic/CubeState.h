@@ -0,0 +1,125 @@
+#ifndef RUBIK_CUBESTATE_H
+#define RUBIK_CUBESTATE_H
+
+#include <string>
+#include "bigint.h"
+#include "FlipSequence.h"
+#include "Random.h"
+
+// state permutation string array length
+#define STATE_STRING_LENGTH 20
+// number of edges in state (edges go first)
+#define STATE_EDGE_COUNT 12
+// number of corners in state (corners follow edges)
+#define STATE_CORNER_COUNT 8
+// maximal length of state string, see CubeState::ToString (edges + corners + separators)
+#define STATE_TEXT_LENGTH (STATE_EDGE_COUNT * 3 + STATE_CORNER_COUNT * 4)
+
+static std::string solvedPermutation[] = { "UF", "UR", "UB", "UL", "DF", "DR", "DB", "DL", "FR", "FL", "BR", "BL", "UFR", "URB", "UBL", "ULF", "DRF", "DFL", "DLB", "DBR" };
+
+// array of affected cubes by specific flip - index matches value from CubeFace,
+// because the only thing we want to know is permutation, and number of those permutations
+// needed to proceed specific flip is determined from enumerator value
+static int flipCubeEffect[][8] = {
+    { 0, 1, 2, 3, 0, 1, 2, 3 },    // U
+    { 4, 7, 6, 5, 4, 5, 6, 7 },    // D
+    { 0, 9, 4, 8, 0, 3, 5, 4 },    // F
+    { 2, 10, 6, 11, 2, 1, 7, 6 },  // B
+    { 3, 11, 7, 9, 3, 2, 6, 5 },   // L
+    { 1, 8, 5, 10, 1, 0, 4, 7 },   // R
+};
+
+// converts flip to move index used in linearized state (faces are in order of flipCubeEffect rows)
+inline int getLinearMoveForFlip(CubeFlip fl)
+{
+    return (5 - fl / 3) * 3 + fl % 3;
+}
+
+// converts move index used in linearized state back to flip
+inline CubeFlip getFlipForLinearMove(int move)
+{
+    return (CubeFlip)((5 - move / 3) * 3 + move % 3);
+}
+
+// result of state validation and solving
+enum SolveResult
+{
+    SOLVE_OK = 0,               // valid state / solution found
+    SOLVE_INVALID_CUBIE = 1,    // cubie which does not exist (i.e. two opposite colors on one cubie)
+    SOLVE_DUPLICATE_CUBIE = 2,  // the same cubie is present twice (and some other is missing)
+    SOLVE_EDGE_FLIP = 3,        // edge flipped in place (sum of edge orientations is odd)
+    SOLVE_CORNER_TWIST = 4,     // corner twisted in place (sum of corner orientations is not divisible by 3)
+    SOLVE_PARITY = 5,           // permutation parity of edges and corners does not match (two cubies swapped)
+    SOLVE_NOT_FOUND = 6,        // search did not find any solution
+    SOLVE_CANCELLED = 7,        // search was cancelled, or it did not finish before its deadline
+    SOLVE_REJECTED = 8,         // the cube was not even searched, the solver is overloaded
+};
+
+// retrieves description of solve result
+static const char* getSolveResultStr(SolveResult res)
+{
+    switch (res)
+    {
+        case SOLVE_OK:              return "OK";
+        case SOLVE_INVALID_CUBIE:   return "invalid cubie (colors which cannot be on the same cubie)";
+        case SOLVE_DUPLICATE_CUBIE: return "duplicate cubie";
+        case SOLVE_EDGE_FLIP:       return "flipped edge";
+        case SOLVE_CORNER_TWIST:    return "twisted corner";
+        case SOLVE_PARITY:          return "odd permutation (two cubies swapped)";
+        case SOLVE_NOT_FOUND:       return "no solution found";
+        case SOLVE_CANCELLED:       return "search cancelled (or its deadline expired)";
+        case SOLVE_REJECTED:        return "rejected (solver overloaded)";
+    }
+    return "unknown error";
+}
+
+// compact cubie level state of cube; it has the same layout as linearized state used by solver - position 0-11
+// are edges, 12-19 corners (in order of solvedPermutation); perm contains index of cubie at that position,
+// orient contains its orientation (index of cyclic permutation of its name, 0-1 for edges, 0-2 for corners)
+struct CubeState
+{
+    unsigned char perm[STATE_STRING_LENGTH];
+    unsigned char orient[STATE_STRING_LENGTH];
+
+    CubeState()
+    {
+        SetSolved();
+    }
+
+    // resets state to solved cube
+    void SetSolved();
+    // is the cube solved?
+    bool IsSolved() const;
+
+    // checks whether the state is reachable from solved cube (only using flips); this takes constant time
+    SolveResult Validate() const;
+
+    // performs flip using precomputed tables (the same result as RubikCube::DoLinearFlip)
+    void DoFlip(CubeFlip flip);
+    // performs sequence of flips
+    void DoFlips(FlipSequence const& flips);
+    // performs sequence of flips written as text (see FromScramble); returns false at the first unknown flip
+    bool DoFlips(const char* str, size_t length);
+
+    // sets uniformly random state - all reachable states have the same probability
+    void Randomize(Random &rng);
+
+    // converts state to linearized solver state (permutation in 0-19, orientation in 20-39)
+    void ToLinear(bigint &dst) const;
+    // converts linearized solver state back
+    void FromLinear(bigint const& src);
+
+    // converts state to permutation string ("UF UR UB ... DBR" for solved cube)
+    std::string ToString() const;
+    // writes permutation string to supplied buffer (at least STATE_TEXT_LENGTH long), returns its length
+    int WriteString(char* dst) const;
+    // parses permutation string; returns false if the string is malformed or contains unknown cubie
+    bool FromString(std::string const& str);
+    // parses permutation string of supplied length (it does not have to be terminated)
+    bool FromString(const char* str, size_t length);
+    // sets state of solved cube scrambled by sequence of flips (as written by FlipSequence::toString, separated by
+    // spaces, commas or tabs); returns false if the sequence contains unknown flip
+    bool FromScramble(const char* str, size_t length);
+};
+
+#endif
@@ -0,0 +1,215 @@
+#include "Global.h"
+#include "FinalStageTable.h"
+
+// ranks permutation of orbit (values 0..3) in lexicographical order
+static int rankOrbitPermutation(const unsigned char* perm)
+{
+    int rank = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        int smaller = 0;
+        for (int j = i + 1; j < 4; j++)
+            if (perm[j] < perm[i])
+                smaller++;
+        rank = rank * (4 - i) + smaller;
+    }
+    return rank;
+}
+
+// inverse of rankOrbitPermutation
+static void unrankOrbitPermutation(int rank, unsigned char* perm)
+{
+    int digits[4];
+    for (int i = 3; i >= 0; i--)
+    {
+        digits[i] = rank % (4 - i);
+        rank /= (4 - i);
+    }
+
+    bool used[4] = { false, false, false, false };
+    for (int i = 0; i < 4; i++)
+    {
+        int skip = digits[i];
+        for (int v = 0; v < 4; v++)
+        {
+            if (used[v])
+                continue;
+            if (skip-- == 0)
+            {
+                perm[i] = (unsigned char)v;
+                used[v] = true;
+                break;
+            }
+        }
+    }
+}
+
+FinalStageTable::FinalStageTable()
+{
+    InitMoveTables();
+}
+
+FinalStageTable::~FinalStageTable()
+{
+    //
+}
+
+// half turn swaps opposite cubies of face cycle, and all of them stay in their orbit, so every orbit permutation
+// just moves to another one; corners of both tetrads are bound together (only 96 of their 576 combinations
+// are reachable), so they are numbered by breadth first search
+void FinalStageTable::InitMoveTables()
+{
+    unsigned char perm[4], newPerm[4];
+
+    for (int face = 0; face < 6; face++)
+    {
+        for (int orbit = 0; orbit < STAGE_ORBIT_COUNT; orbit++)
+        {
+            for (int rank = 0; rank < ORBIT_PERMUTATIONS; rank++)
+            {
+                unrankOrbitPermutation(rank, perm);
+                memcpy(newPerm, perm, sizeof(perm));
+
+                for (int i = 0; i < 8; i++)
+                {
+                    int isCorner = i > 3;
+                    int target = flipCubeEffect[face][i] + isCorner * STATE_EDGE_COUNT;
+                    int source = flipCubeEffect[face][(i & 4) | ((i + 2) & 3)] + isCorner * STATE_EDGE_COUNT;
+
+                    if (stageOrbit[target] == orbit)
+                        newPerm[stageOrbitIndex[target]] = perm[stageOrbitIndex[source]];
+                }
+
+                m_orbitMove[face][orbit][rank] = (unsigned char)rankOrbitPermutation(newPerm);
+            }
+        }
+    }
+
+    // tetrads are orbits 3 and 4
+    for (int i = 0; i < ORBIT_PERMUTATIONS * ORBIT_PERMUTATIONS; i++)
+        m_cornerClass[i] = -1;
+
+    std::vector<int> queue;
+    queue.push_back(0);
+    m_cornerClass[0] = 0;
+
+    for (size_t i = 0; i < queue.size(); i++)
+    {
+        int ranks = queue[i];
+        for (int face = 0; face < 6; face++)
+        {
+            int next = m_orbitMove[face][3][ranks / ORBIT_PERMUTATIONS] * ORBIT_PERMUTATIONS + m_orbitMove[face][4][ranks % ORBIT_PERMUTATIONS];
+            if (m_cornerClass[next] < 0)
+            {
+                m_cornerClass[next] = (short)queue.size();
+                queue.push_back(next);
+            }
+            m_cornerMove[face][m_cornerClass[ranks]] = (unsigned char)m_cornerClass[next];
+        }
+    }
+}
+
+bool FinalStageTable::Init(std::string const& filename)
+{
+    if (m_table.Load(filename, FINAL_STAGE_TABLE_SIZE))
+        return true;
+
+    cout << "Building final stage table..." << endl;
+
+    unsigned long long start = getUSTime();
+    Build(m_table, 0);
+
+    cout << "Built final stage table in " << (double)(getUSTime() - start) / 1000000.0 << " s" << endl;
+
+    // store it to file, so the next time it's just mapped
+    m_table.Store(filename);
+
+    return true;
+}
+
+// the table is built by breadth first search (see PatternDatabase::Build); the last level is never expanded, it
+// is the one left unreached
+void FinalStageTable::Build(PatternDatabase &table, int threads)
+{
+    table.Create(FINAL_STAGE_TABLE_SIZE);
+
+    // solved cube has all ranks and corner class 0
+    table.Build(0, [this](unsigned int index, unsigned int* neighbours) -> int
+    {
+        for (int face = 0; face < 6; face++)
+            neighbours[face] = DoMove(index, face);
+        return 6;
+    }, FINAL_STAGE_MAX_DISTANCE - 1, threads);
+}
+
+unsigned int FinalStageTable::GetIndex(bigint const& state)
+{
+    unsigned char perm[STAGE_ORBIT_COUNT][4];
+
+    for (int i = 0; i < STATE_STRING_LENGTH; i++)
+    {
+        int cubie = state.d[i];
+
+        // every cubie has to be in its orbit, and oriented
+        if (stageOrbit[cubie] != stageOrbit[i] || state.d[i + STATE_STRING_LENGTH] != 0)
+            return FINAL_STAGE_TABLE_SIZE;
+
+        perm[stageOrbit[i]][stageOrbitIndex[i]] = stageOrbitIndex[cubie];
+    }
+
+    int corners = m_cornerClass[rankOrbitPermutation(perm[3]) * ORBIT_PERMUTATIONS + rankOrbitPermutation(perm[4])];
+    if (corners < 0)
+        return FINAL_STAGE_TABLE_SIZE;
+
+    return corners * FINAL_STAGE_EDGE_PERMUTATIONS
+        + (rankOrbitPermutation(perm[0]) * ORBIT_PERMUTATIONS + rankOrbitPermutation(perm[1])) * ORBIT_PERMUTATIONS
+        + rankOrbitPermutation(perm[2]);
+}
+
+unsigned int FinalStageTable::DoMove(unsigned int index, int face)
+{
+    unsigned int corners = index / FINAL_STAGE_EDGE_PERMUTATIONS;
+    unsigned int edges = index % FINAL_STAGE_EDGE_PERMUTATIONS;
+
+    return m_cornerMove[face][corners] * FINAL_STAGE_EDGE_PERMUTATIONS
+        + (m_orbitMove[face][0][edges / (ORBIT_PERMUTATIONS * ORBIT_PERMUTATIONS)] * ORBIT_PERMUTATIONS
+        + m_orbitMove[face][1][(edges / ORBIT_PERMUTATIONS) % ORBIT_PERMUTATIONS]) * ORBIT_PERMUTATIONS
+        + m_orbitMove[face][2][edges % ORBIT_PERMUTATIONS];
+}
+
+// descends the table - there's always a half turn leading to position one half turn closer to solved cube
+bool FinalStageTable::Solve(bigint const& state, std::vector<int> &path)
+{
+    if (!m_table.IsLoaded())
+        return false;
+
+    unsigned int index = GetIndex(state);
+    if (index >= FINAL_STAGE_TABLE_SIZE)
+        return false;
+
+    // unreached entries are the farthest positions (or unreachable ones)
+    int distance = m_table.IsReached(index) ? m_table.GetDistance(index, 0) : FINAL_STAGE_MAX_DISTANCE;
+    while (distance > 0)
+    {
+        int face;
+        for (face = 0; face < 6; face++)
+        {
+            unsigned int next = DoMove(index, face);
+            if (m_table.IsReached(next) && m_table.GetDistance(next, distance) == distance - 1)
+            {
+                index = next;
+                break;
+            }
+        }
+
+        // unreachable position (the parity of edges does not match corners)
+        if (face == 6)
+            return false;
+
+        // half turn of face (see RubikCube::DoLinearFlip)
+        path.push_back(face * 3 + 1);
+        distance--;
+    }
+
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef RUBIK_FINALSTAGETABLE_H
+#define RUBIK_FINALSTAGETABLE_H
+
+#include "Singleton.h"
+#include "SolveStages.h"
+#include "PatternDatabase.h"
+
+// count of permutations of one orbit (4 cubies)
+#define ORBIT_PERMUTATIONS 24
+// count of corner permutations reachable by half turns (out of 24 x 24 permutations of both tetrads)
+#define FINAL_STAGE_CORNER_CLASSES 96
+// count of edge permutations within their slices
+#define FINAL_STAGE_EDGE_PERMUTATIONS (ORBIT_PERMUTATIONS * ORBIT_PERMUTATIONS * ORBIT_PERMUTATIONS)
+// count of table entries; only half of them are reachable (parity of edges has to match parity of corners),
+// but the index is much simpler this way
+#define FINAL_STAGE_TABLE_SIZE (FINAL_STAGE_CORNER_CLASSES * FINAL_STAGE_EDGE_PERMUTATIONS)
+// distance of the farthest positions - it is not stored, they are the ones left unreached by build (the table
+// is small enough to keep exact distances, see PatternDatabase)
+#define FINAL_STAGE_MAX_DISTANCE 15
+
+// distance to solved cube of every position in the last stage of Thistlethwaite's algorithm (half turns only);
+// with the table, the last stage is solved by simple descent, without any search
+class FinalStageTable
+{
+    friend class Singleton<FinalStageTable>;
+    public:
+        ~FinalStageTable();
+
+        // loads the table from file; when the file does not exist (or it's not valid), the table is built and
+        // stored to that file
+        bool Init(std::string const& filename);
+
+        // is the table loaded?
+        bool IsLoaded() { return m_table.IsLoaded(); };
+        // prints memory report line of table
+        void PrintMemoryUsage() { m_table.PrintMemoryUsage("Final stage table"); };
+
+        // builds distances of all positions into table, with supplied count of threads (0 = one per core)
+        void Build(PatternDatabase &table, int threads);
+
+        // appends optimal path (of linear moves) from state to solved cube; returns false, if the state does not
+        // belong to last stage
+        bool Solve(bigint const& state, std::vector<int> &path);
+
+    private:
+        FinalStageTable();
+
+        // builds tables of moves on orbit permutations
+        void InitMoveTables();
+
+        // computes table index of state; returns FINAL_STAGE_TABLE_SIZE, if the state does not belong to last stage
+        unsigned int GetIndex(bigint const& state);
+        // computes table index of position after half turn of face (see LinearFace)
+        unsigned int DoMove(unsigned int index, int face);
+
+        // new rank of orbit permutation after half turn of face
+        unsigned char m_orbitMove[6][STAGE_ORBIT_COUNT][ORBIT_PERMUTATIONS];
+        // corner class of permutation ranks of both tetrads (-1 = not reachable)
+        short m_cornerClass[ORBIT_PERMUTATIONS * ORBIT_PERMUTATIONS];
+        // new corner class after half turn of face
+        unsigned char m_cornerMove[6][FINAL_STAGE_CORNER_CLASSES];
+
+        // distances of positions
+        PatternDatabase m_table;
+};
+
+#define sFinalStageTable Singleton<FinalStageTable>::instance()
+
+#endif
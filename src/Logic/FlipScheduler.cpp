@@ -0,0 +1,105 @@
+#include "Global.h"
+#include "FlipScheduler.h"
+
+// constructor - nothing to be animated at start
+FlipScheduler::FlipScheduler()
+{
+    m_lastTick = 0;
+    m_elapsed = 0;
+    m_flipDuration = 1000;
+}
+
+// puts flip to the end of queue; it will be picked when its turn comes
+void FlipScheduler::Push(CubeFlip flip)
+{
+    // flips of the same axis (R/L, B/F, D/U) have values within the same block of 6 in CubeFlip enumerator;
+    // if the last queued step contains single flip of opposite face, the new one could be done in parallel
+    if (!m_flipQueue.empty())
+    {
+        FlipStep &last = m_flipQueue.back();
+        if (last.flips[1] == FLIP_NONE && last.flips[0] / 6 == flip / 6 && last.flips[0] / 3 != flip / 3)
+        {
+            last.flips[1] = flip;
+            return;
+        }
+    }
+
+    m_flipQueue.push(FlipStep(flip));
+}
+
+// picks the first flip from queue and starts the clock
+void FlipScheduler::Start()
+{
+    // already running - pushed flips will just continue after the current ones
+    if (IsActive() || m_flipQueue.empty())
+        return;
+
+    m_current = m_flipQueue.front();
+    m_flipQueue.pop();
+
+    m_elapsed = 0;
+    m_lastTick = getUSTime();
+}
+
+// stops everything, the current flip is thrown away as well
+void FlipScheduler::Clear()
+{
+    while (!m_flipQueue.empty())
+        m_flipQueue.pop();
+
+    m_current = FlipStep();
+    m_elapsed = 0;
+}
+
+// moves the clock forward and finishes all steps, whose time slot has already passed
+void FlipScheduler::Update(std::vector<CubeFlip> &finished)
+{
+    if (!IsActive())
+        return;
+
+    unsigned long long now = getUSTime();
+    m_elapsed += now - m_lastTick;
+    m_lastTick = now;
+
+    // there may be more than one step finished since last frame (when playing fast, or the frame took long)
+    while (IsActive() && m_elapsed >= m_flipDuration)
+    {
+        finished.push_back(m_current.flips[0]);
+        if (m_current.flips[1] != FLIP_NONE)
+            finished.push_back(m_current.flips[1]);
+
+        // carry over the rest of time to the next step, so the playback does not drift
+        m_elapsed -= m_flipDuration;
+
+        if (!m_flipQueue.empty())
+        {
+            m_current = m_flipQueue.front();
+            m_flipQueue.pop();
+        }
+        else
+        {
+            m_current = FlipStep();
+            m_elapsed = 0;
+        }
+    }
+}
+
+// progress of current step, from 0 to 1
+float FlipScheduler::GetProgress()
+{
+    if (!IsActive())
+        return 0.0f;
+
+    float progress = (float)((double)m_elapsed / (double)m_flipDuration);
+    return (progress > 1.0f) ? 1.0f : progress;
+}
+
+// sets new step duration; current step continues from the same relative progress
+void FlipScheduler::SetFlipDuration(unsigned long long duration)
+{
+    if (duration == 0)
+        duration = 1;
+
+    m_elapsed = (unsigned long long)((double)m_elapsed * (double)duration / (double)m_flipDuration);
+    m_flipDuration = duration;
+}
@@ -0,0 +1,65 @@
+#ifndef RUBIK_FLIPSCHEDULER_H
+#define RUBIK_FLIPSCHEDULER_H
+
+#include <queue>
+#include <vector>
+#include "Flips.h"
+
+// one animated step - a single flip, or two flips of opposite faces; those act on disjoint layers and
+// commute, so they could be animated at once
+struct FlipStep
+{
+    CubeFlip flips[2];
+
+    FlipStep(CubeFlip first = FLIP_NONE, CubeFlip second = FLIP_NONE)
+    {
+        flips[0] = first;
+        flips[1] = second;
+    }
+};
+
+// scheduler of animated flips - every flip gets fixed time slot, measured by monotonic high resolution
+// clock, and the time left over after finishing one flip is carried over to the next one, so the playback
+// does not drift and does not depend on frame rate (even several flips may be finished within one frame);
+// consecutive flips of opposite faces are merged to one step and animated in parallel
+class FlipScheduler
+{
+    public:
+        FlipScheduler();
+
+        // pushes flip to the end of queue (merges it with the last queued step, if possible)
+        void Push(CubeFlip flip);
+        // starts the playback, if not already running
+        void Start();
+        // removes everything from queue and stops the playback
+        void Clear();
+
+        // advances the clock; flips finished since the last call are appended to supplied vector (in order)
+        void Update(std::vector<CubeFlip> &finished);
+
+        // determines, if there is a flip being animated
+        bool IsActive() { return m_current.flips[0] != FLIP_NONE; };
+        // retrieves step being animated right now
+        const FlipStep& GetCurrent() { return m_current; };
+        // retrieves progress of current step (number from 0 to 1)
+        float GetProgress();
+
+        // sets duration of one step in microseconds
+        void SetFlipDuration(unsigned long long duration);
+        // retrieves duration of one step in microseconds
+        unsigned long long GetFlipDuration() { return m_flipDuration; };
+
+    private:
+        // queue of steps to be done
+        std::queue<FlipStep> m_flipQueue;
+        // step actually being progressed
+        FlipStep m_current;
+        // time of last update (us)
+        unsigned long long m_lastTick;
+        // time already spent on current step (us)
+        unsigned long long m_elapsed;
+        // duration of one step (us)
+        unsigned long long m_flipDuration;
+};
+
+#endif
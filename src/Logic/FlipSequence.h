@@ -0,0 +1,199 @@
+#ifndef RUBIK_FLIPSEQUENCE_H
+#define RUBIK_FLIPSEQUENCE_H
+
+#include <string>
+#include <cstring>
+#include "Flips.h"
+
+// how many flips are stored inline, without need of heap allocation
+#define FLIP_SEQUENCE_INLINE 64
+
+// compact sequence of flips - one byte per flip in contiguous storage; sequences up to FLIP_SEQUENCE_INLINE flips
+// (every scramble and Thistlethwaite solution) are stored inline, longer ones are moved to heap
+class FlipSequence
+{
+    public:
+        // read-only iterator, so the sequence could be walked the same way as std::list<CubeFlip>
+        class const_iterator
+        {
+            public:
+                const_iterator(const unsigned char* ptr) : m_ptr(ptr) { }
+
+                CubeFlip operator*() const { return (CubeFlip)*m_ptr; };
+                const_iterator& operator++() { ++m_ptr; return *this; };
+                bool operator==(const const_iterator &other) const { return m_ptr == other.m_ptr; };
+                bool operator!=(const const_iterator &other) const { return m_ptr != other.m_ptr; };
+
+            private:
+                const unsigned char* m_ptr;
+        };
+
+        FlipSequence()
+        {
+            m_data = m_inline;
+            m_size = 0;
+            m_capacity = FLIP_SEQUENCE_INLINE;
+        }
+
+        FlipSequence(FlipSequence const& src)
+        {
+            m_data = m_inline;
+            m_size = 0;
+            m_capacity = FLIP_SEQUENCE_INLINE;
+            append(src);
+        }
+
+        ~FlipSequence()
+        {
+            if (m_data != m_inline)
+                delete[] m_data;
+        }
+
+        FlipSequence& operator=(FlipSequence const& src)
+        {
+            if (this != &src)
+            {
+                m_size = 0;
+                append(src);
+            }
+            return *this;
+        }
+
+        // number of flips in sequence
+        size_t size() const { return m_size; };
+        // is the sequence empty?
+        bool empty() const { return m_size == 0; };
+        // removes all flips (keeps allocated storage)
+        void clear() { m_size = 0; };
+
+        // retrieves flip at specified index
+        CubeFlip operator[](size_t index) const { return (CubeFlip)m_data[index]; };
+        // retrieves last flip
+        CubeFlip back() const { return (CubeFlip)m_data[m_size - 1]; };
+
+        const_iterator begin() const { return const_iterator(m_data); };
+        const_iterator end() const { return const_iterator(m_data + m_size); };
+
+        // appends flip to the end
+        void push_back(CubeFlip flip)
+        {
+            if (m_size == m_capacity)
+                reserve(m_capacity * 2);
+            m_data[m_size++] = (unsigned char)flip;
+        }
+
+        // removes last flip
+        void pop_back()
+        {
+            if (m_size > 0)
+                m_size--;
+        }
+
+        // makes sure there's room for at least "count" flips
+        void reserve(size_t count)
+        {
+            if (count <= m_capacity)
+                return;
+
+            unsigned char* data = new unsigned char[count];
+            memcpy(data, m_data, m_size);
+            if (m_data != m_inline)
+                delete[] m_data;
+
+            m_data = data;
+            m_capacity = (unsigned int)count;
+        }
+
+        // concatenation - appends all flips of other sequence
+        void append(FlipSequence const& src)
+        {
+            reserve(m_size + src.m_size);
+            memcpy(m_data + m_size, src.m_data, src.m_size);
+            m_size += src.m_size;
+        }
+
+        FlipSequence& operator+=(FlipSequence const& src)
+        {
+            append(src);
+            return *this;
+        }
+
+        // reverses order of flips in place
+        void reverse()
+        {
+            for (size_t i = 0, j = m_size; i + 1 < j; i++, j--)
+            {
+                unsigned char tmp = m_data[i];
+                m_data[i] = m_data[j - 1];
+                m_data[j - 1] = tmp;
+            }
+        }
+
+        // retrieves inverse sequence (reversed order, each flip inverted) - it undoes this sequence
+        FlipSequence inverse() const
+        {
+            FlipSequence result;
+            result.reserve(m_size);
+            for (size_t i = m_size; i > 0; i--)
+                result.push_back(getInverseFlip((CubeFlip)m_data[i - 1]));
+            return result;
+        }
+
+        // serializes sequence to string, flips are separated by supplied separator
+        std::string toString(const char* separator = " ") const
+        {
+            std::string result;
+            for (size_t i = 0; i < m_size; i++)
+            {
+                if (i > 0)
+                    result += separator;
+                result += cubeFlipStr[m_data[i]];
+            }
+            return result;
+        }
+
+        // parses sequence from string (flips separated by spaces, commas or tabs); appends flips to current contents,
+        // returns false when unknown flip was found
+        bool fromString(std::string const& str)
+        {
+            char token[3];
+            size_t i = 0;
+            while (i < str.length())
+            {
+                // skip separators
+                if (str[i] == ' ' || str[i] == ',' || str[i] == '\t' || str[i] == '\r' || str[i] == '\n')
+                {
+                    i++;
+                    continue;
+                }
+
+                // every flip is exactly two characters long, followed by separator or end of string
+                if (i + 1 >= str.length() || (i + 2 < str.length() && str[i + 2] != ' ' && str[i + 2] != ',' && str[i + 2] != '\t' && str[i + 2] != '\r' && str[i + 2] != '\n'))
+                    return false;
+
+                token[0] = str[i];
+                token[1] = str[i + 1];
+                token[2] = '\0';
+
+                CubeFlip fl = getFlipForStr(token);
+                if (fl == FLIP_NONE)
+                    return false;
+
+                push_back(fl);
+                i += 2;
+            }
+            return true;
+        }
+
+    private:
+        // data storage (points to inline buffer, or to heap)
+        unsigned char* m_data;
+        // number of flips stored
+        unsigned int m_size;
+        // capacity of current storage
+        unsigned int m_capacity;
+        // inline storage for short sequences
+        unsigned char m_inline[FLIP_SEQUENCE_INLINE];
+};
+
+#endif
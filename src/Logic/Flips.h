@@ -0,0 +1,66 @@
+#ifndef RUBIK_FLIPS_H
+#define RUBIK_FLIPS_H
+
+// half-turn metric flips
+enum CubeFlip
+{
+    FLIP_R_P = 0,
+    FLIP_R_2 = 1,
+    FLIP_R_N = 2,
+
+    FLIP_L_P = 3,
+    FLIP_L_2 = 4,
+    FLIP_L_N = 5,
+
+    FLIP_B_P = 6,
+    FLIP_B_2 = 7,
+    FLIP_B_N = 8,
+
+    FLIP_F_P = 9,
+    FLIP_F_2 = 10,
+    FLIP_F_N = 11,
+
+    FLIP_D_P = 12,
+    FLIP_D_2 = 13,
+    FLIP_D_N = 14,
+
+    FLIP_U_P = 15,
+    FLIP_U_2 = 16,
+    FLIP_U_N = 17,
+
+    FLIP_MAX = FLIP_U_N + 1,
+    FLIP_BEGIN = FLIP_R_P,
+
+    FLIP_NONE = FLIP_MAX    // used just as "flag", not real turn
+};
+
+// strings representing each flip (index matches value from CubeFlip enumerator)
+static char* cubeFlipStr[] = { "R+", "R2", "R-", "L+", "L2", "L-", "B+", "B2", "B-", "F+", "F2", "F-", "D+", "D2", "D-", "U+", "U2", "U-" };
+
+// retrieves flip for supplied string identifier
+static CubeFlip getFlipForStr(char* str)
+{
+    for (int i = 0; i < FLIP_MAX; i++)
+    {
+        if (strcmp(str, cubeFlipStr[i]) == 0)
+            return (CubeFlip)i;
+    }
+
+    return FLIP_NONE;
+}
+
+// retrieves inverse flip (just inverses the offset within flip group, see CubeFlip enumerator)
+static CubeFlip getInverseFlip(CubeFlip fl)
+{
+    return (CubeFlip)(fl + 2 - 2 * (fl % 3));
+}
+
+// retrieves string representing current flip
+static char* getStrForFlip(CubeFlip fl)
+{
+    if (fl < FLIP_MAX)
+        return cubeFlipStr[fl];
+    return nullptr;
+}
+
+#endif
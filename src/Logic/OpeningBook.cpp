@@ -0,0 +1,289 @@
+#include "Global.h"
+#include "OpeningBook.h"
+
+#include <fstream>
+
+// ranks permutation of n elements in lexicographical order (Lehmer code) - only the relative order of values
+// matters, so they do not have to start at zero
+static unsigned int rankPermutation(const unsigned char* perm, int n)
+{
+    unsigned int rank = 0;
+    for (int i = 0; i < n; i++)
+    {
+        int smaller = 0;
+        for (int j = i + 1; j < n; j++)
+            if (perm[j] < perm[i])
+                smaller++;
+        rank = rank * (n - i) + smaller;
+    }
+    return rank;
+}
+
+// inverse of rankPermutation
+static void unrankPermutation(unsigned int rank, unsigned char* perm, int n, int base)
+{
+    // digits of factorial number system, from the last one
+    int digits[STATE_EDGE_COUNT];
+    for (int i = n - 1; i >= 0; i--)
+    {
+        digits[i] = rank % (n - i);
+        rank /= (n - i);
+    }
+
+    // every digit says, which of the unused values comes next
+    bool used[STATE_EDGE_COUNT] = { false };
+    for (int i = 0; i < n; i++)
+    {
+        int skip = digits[i];
+        for (int v = 0; v < n; v++)
+        {
+            if (used[v])
+                continue;
+            if (skip-- == 0)
+            {
+                perm[i] = (unsigned char)(base + v);
+                used[v] = true;
+                break;
+            }
+        }
+    }
+}
+
+void OpeningBookEntry::Encode(CubeState const& state)
+{
+    unsigned int edgeOrient = 0, cornerOrient = 0;
+    for (int i = 0; i < STATE_EDGE_COUNT - 1; i++)
+        edgeOrient |= state.orient[i] << i;
+    for (int i = STATE_STRING_LENGTH - 2; i >= STATE_EDGE_COUNT; i--)
+        cornerOrient = cornerOrient * 3 + state.orient[i];
+
+    edgePermutation = rankPermutation(state.perm, STATE_EDGE_COUNT);
+    edgeOrientCornerPermutation = (edgeOrient << 16) | rankPermutation(state.perm + STATE_EDGE_COUNT, STATE_CORNER_COUNT);
+    cornerOrientFlip = (cornerOrient << 8) | FLIP_NONE;
+}
+
+void OpeningBookEntry::Decode(CubeState &state) const
+{
+    unrankPermutation(edgePermutation, state.perm, STATE_EDGE_COUNT, 0);
+    unrankPermutation(edgeOrientCornerPermutation & 0xFFFF, state.perm + STATE_EDGE_COUNT, STATE_CORNER_COUNT, STATE_EDGE_COUNT);
+
+    // sum of edge orientations is even, sum of corner orientations is divisible by 3
+    unsigned int edgeOrient = edgeOrientCornerPermutation >> 16;
+    int sum = 0;
+    for (int i = 0; i < STATE_EDGE_COUNT - 1; i++)
+    {
+        state.orient[i] = (edgeOrient >> i) & 1;
+        sum += state.orient[i];
+    }
+    state.orient[STATE_EDGE_COUNT - 1] = sum & 1;
+
+    unsigned int cornerOrient = cornerOrientFlip >> 8;
+    sum = 0;
+    for (int i = STATE_EDGE_COUNT; i < STATE_STRING_LENGTH - 1; i++)
+    {
+        state.orient[i] = cornerOrient % 3;
+        cornerOrient /= 3;
+        sum += state.orient[i];
+    }
+    state.orient[STATE_STRING_LENGTH - 1] = (3 - sum % 3) % 3;
+}
+
+// orders entries by state, and then by flip (so the build is deterministic)
+static bool entryLessWithFlip(OpeningBookEntry const& a, OpeningBookEntry const& b)
+{
+    if (a < b)
+        return true;
+    if (b < a)
+        return false;
+    return a.GetFlip() < b.GetFlip();
+}
+
+static bool entrySameState(OpeningBookEntry const& a, OpeningBookEntry const& b)
+{
+    return a.SameState(b);
+}
+
+OpeningBook::OpeningBook()
+{
+    m_entries = nullptr;
+    m_count = 0;
+    m_depth = 0;
+}
+
+OpeningBook::~OpeningBook()
+{
+    //
+}
+
+bool OpeningBook::Init(int depth, std::string const& filename)
+{
+    if (depth <= 0)
+        return false;
+    if (depth > OPENING_BOOK_DEPTH_MAX)
+        depth = OPENING_BOOK_DEPTH_MAX;
+
+    if (Load(filename, depth))
+        return true;
+
+    cout << "Building opening book of depth " << depth << "..." << endl;
+
+    unsigned long long start = getUSTime();
+    Build(depth, m_memoryEntries);
+
+    cout << "Built " << m_memoryEntries.size() << " positions in " << (double)(getUSTime() - start) / 1000000.0 << " s" << endl;
+
+    // store it to file, so the next time it's just mapped
+    OpeningBookHeader header;
+    header.magic = OPENING_BOOK_MAGIC;
+    header.version = OPENING_BOOK_VERSION;
+    header.depth = depth;
+    header.count = (unsigned int)m_memoryEntries.size();
+
+    ofstream f;
+    f.open(filename.c_str(), ios::out | ios::binary);
+    if (!f.fail() && f.is_open())
+    {
+        f.write((const char*)&header, sizeof(OpeningBookHeader));
+        f.write((const char*)&m_memoryEntries[0], sizeof(OpeningBookEntry) * m_memoryEntries.size());
+        f.close();
+
+        if (Load(filename, depth))
+        {
+            std::vector<OpeningBookEntry>().swap(m_memoryEntries);
+            return true;
+        }
+    }
+
+    cerr << "Could not store opening book to " << filename << ", using it from memory" << endl;
+
+    m_entries = &m_memoryEntries[0];
+    m_count = (unsigned int)m_memoryEntries.size();
+    m_depth = depth;
+
+    return true;
+}
+
+// the book is built by breadth first search - every level is sorted, and the positions already present
+// in the previous two levels are dropped (neighbours of position are at most one level farther or closer);
+// the flip leading to the position is inverted, so it's the first flip of optimal solution
+void OpeningBook::Build(int depth, std::vector<OpeningBookEntry> &entries)
+{
+    std::vector<OpeningBookEntry> previous, current, next;
+    CubeState state, flipped;
+    OpeningBookEntry entry;
+
+    entry.Encode(state);
+    current.push_back(entry);
+    entries = current;
+
+    for (int level = 1; level <= depth; level++)
+    {
+        next.clear();
+        next.reserve(current.size() * 15);
+
+        for (size_t i = 0; i < current.size(); i++)
+        {
+            current[i].Decode(state);
+            CubeFlip last = current[i].GetFlip();
+
+            for (int fl = FLIP_BEGIN; fl < FLIP_MAX; fl++)
+            {
+                // flip of the same face as the last one leads to the same or shallower level
+                if (last != FLIP_NONE && fl / 3 == last / 3)
+                    continue;
+
+                flipped = state;
+                flipped.DoFlip((CubeFlip)fl);
+
+                entry.Encode(flipped);
+                entry.SetFlip(getInverseFlip((CubeFlip)fl));
+                next.push_back(entry);
+            }
+        }
+
+        sort(next.begin(), next.end(), entryLessWithFlip);
+        next.erase(unique(next.begin(), next.end(), entrySameState), next.end());
+
+        // drop positions of previous levels
+        size_t count = 0;
+        for (size_t i = 0; i < next.size(); i++)
+        {
+            if (binary_search(current.begin(), current.end(), next[i]) || binary_search(previous.begin(), previous.end(), next[i]))
+                continue;
+            next[count++] = next[i];
+        }
+        next.resize(count);
+
+        previous.swap(current);
+        current.swap(next);
+
+        entries.insert(entries.end(), current.begin(), current.end());
+    }
+
+    sort(entries.begin(), entries.end());
+}
+
+bool OpeningBook::Load(std::string const& filename, int depth)
+{
+    if (!m_file.Open(filename.c_str()))
+        return false;
+
+    const OpeningBookHeader* header = (const OpeningBookHeader*)m_file.GetData();
+    if (m_file.GetSize() < sizeof(OpeningBookHeader) || header->magic != OPENING_BOOK_MAGIC || header->version != OPENING_BOOK_VERSION
+        || (int)header->depth != depth || m_file.GetSize() != sizeof(OpeningBookHeader) + sizeof(OpeningBookEntry) * (size_t)header->count)
+    {
+        m_file.Close();
+        return false;
+    }
+
+    m_entries = (const OpeningBookEntry*)(m_file.GetData() + sizeof(OpeningBookHeader));
+    m_count = header->count;
+    m_depth = depth;
+
+    return true;
+}
+
+const OpeningBookEntry* OpeningBook::Find(OpeningBookEntry const& key)
+{
+    const OpeningBookEntry* end = m_entries + m_count;
+    const OpeningBookEntry* itr = lower_bound(m_entries, end, key);
+    if (itr == end || !itr->SameState(key))
+        return nullptr;
+    return itr;
+}
+
+// follows the stored flips - every one of them leads to position one flip closer to solved cube
+bool OpeningBook::Solve(CubeState const& state, FlipSequence *target)
+{
+    if (!m_count)
+        return false;
+
+    CubeState current = state;
+    OpeningBookEntry key;
+    FlipSequence solution;
+
+    for (int i = 0; i <= m_depth; i++)
+    {
+        key.Encode(current);
+        const OpeningBookEntry* entry = Find(key);
+        if (!entry)
+            return false;
+
+        if (entry->GetFlip() == FLIP_NONE)
+        {
+            target->append(solution);
+            return true;
+        }
+
+        solution.push_back(entry->GetFlip());
+        current.DoFlip(entry->GetFlip());
+    }
+
+    return false;
+}
+
+void OpeningBook::PrintMemoryUsage()
+{
+    cout << "- Opening book: " << (double)(sizeof(OpeningBookEntry) * (size_t)m_count) / (1024.0 * 1024.0) << " MB (" << m_count << " entries, "
+        << sizeof(OpeningBookEntry) << " bytes each" << (m_file.IsOpen() ? ", mapped" : ", in memory") << ")" << endl;
+}
@@ -0,0 +1,112 @@
+#ifndef RUBIK_OPENINGBOOK_H
+#define RUBIK_OPENINGBOOK_H
+
+#include "Singleton.h"
+#include "CubeState.h"
+#include "MappedFile.h"
+
+// default depth of opening book (all positions within this count of flips from solved cube are stored)
+#define OPENING_BOOK_DEPTH_DEFAULT 5
+// maximal depth of opening book (depth 8 has about 1.3 billion positions, which is way beyond any reasonable size)
+#define OPENING_BOOK_DEPTH_MAX 8
+// identifier of opening book file ("ROBK")
+#define OPENING_BOOK_MAGIC 0x4B424F52
+// version of opening book file format
+#define OPENING_BOOK_VERSION 1
+
+// opening book file header - it's followed by entries, sorted by state
+struct OpeningBookHeader
+{
+    unsigned int magic;
+    unsigned int version;
+    unsigned int depth;
+    unsigned int count;
+};
+
+// one position of opening book - exact code of cube state (96 bits), and the first flip of its optimal solution
+struct OpeningBookEntry
+{
+    // rank of edge permutation (< 12!)
+    unsigned int edgePermutation;
+    // orientations of first 11 edges (bits 16-26) and rank of corner permutation (< 8!, bits 0-15)
+    unsigned int edgeOrientCornerPermutation;
+    // orientations of first 7 corners in base 3 (< 3^7, bits 8-19) and the flip (bits 0-7)
+    unsigned int cornerOrientFlip;
+
+    // encodes state (the flip is set to FLIP_NONE); orientation of last edge and last corner is given by the others
+    void Encode(CubeState const& state);
+    // decodes state
+    void Decode(CubeState &state) const;
+
+    // retrieves the first flip of optimal solution (FLIP_NONE for solved cube)
+    CubeFlip GetFlip() const { return (CubeFlip)(cornerOrientFlip & 0xFF); };
+    // sets the first flip of optimal solution
+    void SetFlip(CubeFlip flip) { cornerOrientFlip = (cornerOrientFlip & ~0xFFU) | (unsigned int)flip; };
+
+    // entries are ordered by state (the flip does not matter)
+    bool operator<(OpeningBookEntry const& other) const
+    {
+        if (edgePermutation != other.edgePermutation)
+            return edgePermutation < other.edgePermutation;
+        if (edgeOrientCornerPermutation != other.edgeOrientCornerPermutation)
+            return edgeOrientCornerPermutation < other.edgeOrientCornerPermutation;
+        return (cornerOrientFlip >> 8) < (other.cornerOrientFlip >> 8);
+    }
+
+    // do both entries encode the same state?
+    bool SameState(OpeningBookEntry const& other) const
+    {
+        return edgePermutation == other.edgePermutation && edgeOrientCornerPermutation == other.edgeOrientCornerPermutation
+            && (cornerOrientFlip >> 8) == (other.cornerOrientFlip >> 8);
+    }
+};
+
+// table of all positions within few flips from solved cube, with their optimal solution; it's built just once,
+// stored to file and memory mapped, so the lookup is just binary search
+class OpeningBook
+{
+    friend class Singleton<OpeningBook>;
+    public:
+        ~OpeningBook();
+
+        // loads opening book of specified depth from file; when the file does not exist (or it's not valid),
+        // the book is built and stored to that file
+        bool Init(int depth, std::string const& filename);
+
+        // is there any book loaded?
+        bool IsLoaded() { return m_count > 0; };
+        // retrieves depth of book
+        int GetDepth() { return m_depth; };
+        // retrieves count of positions in book
+        unsigned int GetCount() { return m_count; };
+        // prints memory report line of book
+        void PrintMemoryUsage();
+
+        // appends optimal solution of state to target; returns false, if the state is not in book
+        bool Solve(CubeState const& state, FlipSequence *target);
+
+    private:
+        OpeningBook();
+
+        // builds sorted entries of all positions within depth
+        void Build(int depth, std::vector<OpeningBookEntry> &entries);
+        // maps book from file, if the file is valid book of requested depth
+        bool Load(std::string const& filename, int depth);
+        // finds entry with the same state as supplied key
+        const OpeningBookEntry* Find(OpeningBookEntry const& key);
+
+        // mapped book file
+        MappedFile m_file;
+        // entries built in memory (used only when the book could not be stored to file)
+        std::vector<OpeningBookEntry> m_memoryEntries;
+        // sorted entries
+        const OpeningBookEntry* m_entries;
+        // count of entries
+        unsigned int m_count;
+        // depth of book
+        int m_depth;
+};
+
+#define sOpeningBook Singleton<OpeningBook>::instance()
+
+#endif
@@ -0,0 +1,521 @@
+#include "Global.h"
+#include "OptimalSolver.h"
+
+#include <thread>
+#include <sstream>
+
+// "first cubie" of corner pattern database (edge databases are identified by their first edge)
+#define CORNER_DATABASE -1
+
+OptimalSolver::OptimalSolver()
+{
+    m_edgeCount = OPTIMAL_EDGES_DEFAULT;
+    m_threadCount = 0;
+    m_lastNodes = 0;
+    m_nextRoot = 0;
+    m_found = false;
+    m_cancelled = false;
+
+    InitMoveTables();
+}
+
+OptimalSolver::~OptimalSolver()
+{
+    //
+}
+
+// ranks corner permutation of cubie state (Lehmer code)
+static unsigned int rankCornerPermutation(CubeState const& state)
+{
+    const unsigned char* perm = state.perm + STATE_EDGE_COUNT;
+
+    unsigned int rank = 0;
+    for (int i = 0; i < STATE_CORNER_COUNT; i++)
+    {
+        int smaller = 0;
+        for (int j = i + 1; j < STATE_CORNER_COUNT; j++)
+            if (perm[j] < perm[i])
+                smaller++;
+        rank = rank * (STATE_CORNER_COUNT - i) + smaller;
+    }
+    return rank;
+}
+
+// sets corner permutation of cubie state by its rank
+static void unrankCornerPermutation(unsigned int rank, CubeState &state)
+{
+    // digits of factorial number system say, which of unused cubies comes next
+    int digits[STATE_CORNER_COUNT];
+    for (int i = STATE_CORNER_COUNT - 1; i >= 0; i--)
+    {
+        digits[i] = rank % (STATE_CORNER_COUNT - i);
+        rank /= (STATE_CORNER_COUNT - i);
+    }
+
+    bool used[STATE_CORNER_COUNT] = { false };
+    for (int i = 0; i < STATE_CORNER_COUNT; i++)
+    {
+        int skip = digits[i];
+        for (int c = 0; c < STATE_CORNER_COUNT; c++)
+        {
+            if (used[c] || skip-- > 0)
+                continue;
+            state.perm[STATE_EDGE_COUNT + i] = (unsigned char)(STATE_EDGE_COUNT + c);
+            used[c] = true;
+            break;
+        }
+    }
+}
+
+// encodes orientations of first 7 corners of cubie state in base 3
+static unsigned int getCornerTwist(CubeState const& state)
+{
+    unsigned int twist = 0;
+    for (int i = STATE_EDGE_COUNT; i < STATE_STRING_LENGTH - 1; i++)
+        twist = twist * 3 + state.orient[i];
+    return twist;
+}
+
+// sets corner orientations of cubie state (the last one is given by the others)
+static void setCornerTwist(unsigned int twist, CubeState &state)
+{
+    int sum = 0;
+    for (int i = STATE_STRING_LENGTH - 2; i >= STATE_EDGE_COUNT; i--)
+    {
+        state.orient[i] = (unsigned char)(twist % 3);
+        twist /= 3;
+        sum += state.orient[i];
+    }
+    state.orient[STATE_STRING_LENGTH - 1] = (unsigned char)((3 - sum % 3) % 3);
+}
+
+// flip tables are taken from cubie state - corner coordinates are flipped as whole (orientations are bound to
+// positions in cubie state, so they don't depend on permutation), and flip of solved cube says, where every
+// edge goes
+void OptimalSolver::InitMoveTables()
+{
+    CubeState state;
+
+    for (int fl = FLIP_BEGIN; fl < FLIP_MAX; fl++)
+    {
+        for (unsigned int rank = 0; rank < CORNER_PERMUTATIONS; rank++)
+        {
+            unrankCornerPermutation(rank, state);
+            state.DoFlip((CubeFlip)fl);
+            m_cornerPermutationMove[rank][fl] = (unsigned short)rankCornerPermutation(state);
+        }
+
+        for (unsigned int twist = 0; twist < CORNER_ORIENTATIONS; twist++)
+        {
+            setCornerTwist(twist, state);
+            state.DoFlip((CubeFlip)fl);
+            m_cornerTwistMove[twist][fl] = (unsigned short)getCornerTwist(state);
+        }
+
+        state.SetSolved();
+        state.DoFlip((CubeFlip)fl);
+        for (int i = 0; i < STATE_EDGE_COUNT; i++)
+        {
+            m_edgePositionMove[fl][state.perm[i]] = (unsigned char)i;
+            m_edgeFlipMove[fl][state.perm[i]] = state.orient[i];
+        }
+    }
+
+    // root subtrees - pairs of flips, which are not redundant (see Search)
+    for (int first = FLIP_BEGIN; first < FLIP_MAX; first++)
+    {
+        for (int second = FLIP_BEGIN; second < FLIP_MAX; second++)
+        {
+            if (second / 3 == first / 3 || (second / 3 == ((first / 3) ^ 1) && second / 3 < first / 3))
+                continue;
+            m_roots.push_back(std::make_pair((CubeFlip)first, (CubeFlip)second));
+        }
+    }
+}
+
+void OptimalSolver::ToOptimalCube(CubeState const& state, OptimalCube &dst)
+{
+    dst.cornerPermutation = (unsigned short)rankCornerPermutation(state);
+    dst.cornerTwist = (unsigned short)getCornerTwist(state);
+
+    for (int i = 0; i < STATE_EDGE_COUNT; i++)
+    {
+        dst.edgePosition[state.perm[i]] = (unsigned char)i;
+        dst.edgeOrient[state.perm[i]] = state.orient[i];
+    }
+}
+
+inline void OptimalSolver::DoCornerFlip(OptimalCube const& src, CubeFlip flip, OptimalCube &dst)
+{
+    dst.cornerPermutation = m_cornerPermutationMove[src.cornerPermutation][flip];
+    dst.cornerTwist = m_cornerTwistMove[src.cornerTwist][flip];
+}
+
+inline void OptimalSolver::DoEdgeFlip(OptimalCube const& src, CubeFlip flip, OptimalCube &dst, int begin, int end)
+{
+    const unsigned char* position = m_edgePositionMove[flip];
+    const unsigned char* change = m_edgeFlipMove[flip];
+
+    for (int i = begin; i < end; i++)
+    {
+        dst.edgePosition[i] = position[src.edgePosition[i]];
+        dst.edgeOrient[i] = src.edgeOrient[i] ^ change[src.edgePosition[i]];
+    }
+}
+
+// rank of positions of edges (partial permutation of 12 positions), followed by their orientations
+unsigned int OptimalSolver::GetEdgeIndex(OptimalCube const& cube, int first)
+{
+    const unsigned char* pos = cube.edgePosition + first;
+    const unsigned char* orient = cube.edgeOrient + first;
+
+    unsigned int rank = 0, flips = 0;
+    for (int i = 0; i < m_edgeCount; i++)
+    {
+        // count of positions not used by previous edges, which are lower than the position of this one
+        int digit = pos[i];
+        for (int j = 0; j < i; j++)
+            if (pos[j] < pos[i])
+                digit--;
+        rank = rank * (STATE_EDGE_COUNT - i) + digit;
+        flips |= orient[i] << i;
+    }
+
+    return (rank << m_edgeCount) | flips;
+}
+
+void OptimalSolver::SetEdgeIndex(OptimalCube &cube, unsigned int index, int first)
+{
+    unsigned char* pos = cube.edgePosition + first;
+    unsigned char* orient = cube.edgeOrient + first;
+
+    for (int i = 0; i < m_edgeCount; i++)
+        orient[i] = (index >> i) & 1;
+
+    unsigned int rank = index >> m_edgeCount;
+    int digits[STATE_EDGE_COUNT];
+    for (int i = m_edgeCount - 1; i >= 0; i--)
+    {
+        digits[i] = rank % (STATE_EDGE_COUNT - i);
+        rank /= (STATE_EDGE_COUNT - i);
+    }
+
+    bool used[STATE_EDGE_COUNT] = { false };
+    for (int i = 0; i < m_edgeCount; i++)
+    {
+        int skip = digits[i];
+        for (int p = 0; p < STATE_EDGE_COUNT; p++)
+        {
+            if (used[p] || skip-- > 0)
+                continue;
+            pos[i] = (unsigned char)p;
+            used[p] = true;
+            break;
+        }
+    }
+}
+
+inline unsigned int OptimalSolver::GetIndex(OptimalCube const& cube, int first)
+{
+    return (first == CORNER_DATABASE) ? cube.GetCornerIndex() : GetEdgeIndex(cube, first);
+}
+
+inline void OptimalSolver::DoDatabaseFlip(OptimalCube const& src, CubeFlip flip, OptimalCube &dst, int first)
+{
+    if (first == CORNER_DATABASE)
+        DoCornerFlip(src, flip, dst);
+    else
+        DoEdgeFlip(src, flip, dst, first, first + m_edgeCount);
+}
+
+// the distances are stored modulo 3, so the exact one is found by walking down the database to solved cube (there's
+// always a flip leading one step closer, and it's the only neighbour with distance lower by one modulo 3); it's
+// done just for the root of search, the rest is decoded from parent
+int OptimalSolver::GetExactDistance(PatternDatabase const& db, OptimalCube const& cube, int first)
+{
+    if (db.GetPacking() == PATTERN_PACKING_NIBBLE)
+        return db.GetDistance(GetIndex(cube, first), 0);
+
+    OptimalCube solved, current = cube, next = cube;
+    ToOptimalCube(CubeState(), solved);
+    unsigned int solvedIndex = GetIndex(solved, first);
+
+    int distance = 0;
+    unsigned int index = GetIndex(current, first);
+    while (index != solvedIndex)
+    {
+        int stored = 0;
+        while (!db.IsAtDistance(index, stored))
+            stored++;
+
+        int fl;
+        for (fl = FLIP_BEGIN; fl < FLIP_MAX; fl++)
+        {
+            DoDatabaseFlip(current, (CubeFlip)fl, next, first);
+            if (db.IsAtDistance(GetIndex(next, first), stored + 2))
+                break;
+        }
+
+        // should not happen for valid database
+        if (fl == FLIP_MAX)
+            break;
+
+        current = next;
+        index = GetIndex(current, first);
+        distance++;
+    }
+
+    return distance;
+}
+
+bool OptimalSolver::Init(int edgeCount, std::string const& directory)
+{
+    if (edgeCount < OPTIMAL_EDGES_MIN)
+        edgeCount = OPTIMAL_EDGES_MIN;
+    if (edgeCount > OPTIMAL_EDGES_MAX)
+        edgeCount = OPTIMAL_EDGES_MAX;
+    m_edgeCount = edgeCount;
+
+    std::ostringstream edgesFirst, edgesLast;
+    edgesFirst << directory << "optimal_edges" << m_edgeCount << "_0.bin";
+    edgesLast << directory << "optimal_edges" << m_edgeCount << "_" << (STATE_EDGE_COUNT - m_edgeCount) << ".bin";
+
+    InitDatabase(m_corners, directory + "optimal_corners.bin", CORNER_DATABASE);
+    InitDatabase(m_edgesFirst, edgesFirst.str(), 0);
+    InitDatabase(m_edgesLast, edgesLast.str(), STATE_EDGE_COUNT - m_edgeCount);
+
+    return IsLoaded();
+}
+
+void OptimalSolver::InitDatabase(PatternDatabase &db, std::string const& filename, int first)
+{
+    unsigned int size = CORNER_PERMUTATIONS * CORNER_ORIENTATIONS;
+    if (first != CORNER_DATABASE)
+    {
+        // partial permutation of edges, and their orientations
+        size = 1;
+        for (int i = 0; i < m_edgeCount; i++)
+            size *= STATE_EDGE_COUNT - i;
+        size <<= m_edgeCount;
+    }
+
+    if (db.Load(filename, size))
+        return;
+
+    cout << "Building pattern database " << filename << " (" << size << " entries)..." << endl;
+
+    unsigned long long start = getUSTime();
+    db.Create(size);
+    BuildDatabase(db, first, m_threadCount);
+
+    cout << "Built pattern database in " << (double)(getUSTime() - start) / 1000000.0 << " s" << endl;
+
+    db.Store(filename);
+}
+
+// the database is built by breadth first search over its indexes (see PatternDatabase::Build); the neighbours
+// are found by flipping just the cubies of database
+void OptimalSolver::BuildDatabase(PatternDatabase &db, int first, int threads)
+{
+    OptimalCube solved;
+    ToOptimalCube(CubeState(), solved);
+
+    db.Build(GetIndex(solved, first), [this, &solved, first](unsigned int index, unsigned int* neighbours) -> int
+    {
+        OptimalCube cube = solved, next = solved;
+        if (first == CORNER_DATABASE)
+        {
+            cube.cornerPermutation = (unsigned short)(index / CORNER_ORIENTATIONS);
+            cube.cornerTwist = (unsigned short)(index % CORNER_ORIENTATIONS);
+        }
+        else
+            SetEdgeIndex(cube, index, first);
+
+        for (int fl = FLIP_BEGIN; fl < FLIP_MAX; fl++)
+        {
+            DoDatabaseFlip(cube, (CubeFlip)fl, next, first);
+            neighbours[fl] = GetIndex(next, first);
+        }
+
+        return FLIP_MAX;
+    }, OPTIMAL_DEPTH_MAX, threads);
+}
+
+void OptimalSolver::BuildCornerDatabase(PatternDatabase &db, int threads)
+{
+    db.Create(CORNER_PERMUTATIONS * CORNER_ORIENTATIONS);
+    BuildDatabase(db, CORNER_DATABASE, threads);
+}
+
+// performs flip during search, and decodes distances of new node from its parent; the databases are asked one
+// by one, the cheapest first, so the most of nodes is pruned early
+inline bool OptimalSolver::Expand(OptimalWorker &worker, OptimalCube const& cube, CubeFlip flip, OptimalCube &next, int depth, int bound)
+{
+    worker.nodes++;
+
+    DoCornerFlip(cube, flip, next);
+    next.distance[0] = (unsigned char)m_corners.GetDistance(next.GetCornerIndex(), cube.distance[0]);
+    if (depth + next.distance[0] > bound)
+        return false;
+
+    DoEdgeFlip(cube, flip, next, 0, STATE_EDGE_COUNT);
+    next.distance[1] = (unsigned char)m_edgesFirst.GetDistance(GetEdgeIndex(next, 0), cube.distance[1]);
+    if (depth + next.distance[1] > bound)
+        return false;
+
+    next.distance[2] = (unsigned char)m_edgesLast.GetDistance(GetEdgeIndex(next, STATE_EDGE_COUNT - m_edgeCount), cube.distance[2]);
+    if (depth + next.distance[2] > bound)
+        return false;
+
+    return true;
+}
+
+// depth first search with pruning by estimate; the flips of the same face as the last one are skipped (they could
+// be merged with it), and the flips of opposite faces commute, so they are tried just in one order
+bool OptimalSolver::Search(OptimalWorker &worker, OptimalCube const& cube, int depth, int bound, int lastFace)
+{
+    // every cubie is in some database, so zero distances mean solved cube
+    if ((cube.distance[0] | cube.distance[1] | cube.distance[2]) == 0)
+    {
+        std::lock_guard<std::mutex> guard(m_solutionLock);
+        if (!m_found)
+        {
+            m_solution.assign(worker.path, worker.path + depth);
+            m_found = true;
+        }
+        return true;
+    }
+
+    // the worker of calling thread checks the control once in a while; the other workers just follow
+    if (worker.control && --worker.untilPoll <= 0)
+    {
+        worker.untilPoll = SOLVE_CONTROL_INTERVAL;
+
+        SolveProgress progress;
+        progress.stage = 0;
+        progress.depth = bound;
+        progress.expanded = m_lastNodes + worker.nodes;
+        progress.forwardFrontier = 0;
+        progress.backwardFrontier = 0;
+        if (worker.control->Poll(progress))
+            m_cancelled = true;
+    }
+
+    // some other worker already found the solution (or the search was cancelled)
+    if (m_found || m_cancelled)
+        return true;
+
+    OptimalCube next;
+    for (int fl = FLIP_BEGIN; fl < FLIP_MAX; fl++)
+    {
+        int face = fl / 3;
+        if (face == lastFace || (face == (lastFace ^ 1) && face < lastFace))
+            continue;
+
+        if (!Expand(worker, cube, (CubeFlip)fl, next, depth + 1, bound))
+            continue;
+
+        worker.path[depth] = (CubeFlip)fl;
+        if (Search(worker, next, depth + 1, bound, face))
+            return true;
+    }
+
+    return false;
+}
+
+void OptimalSolver::SearchRoots(OptimalWorker &worker, OptimalCube const& cube, int bound)
+{
+    OptimalCube afterFirst, afterSecond;
+
+    while (!m_found && !m_cancelled)
+    {
+        unsigned int root = m_nextRoot++;
+        if (root >= m_roots.size())
+            break;
+
+        worker.path[0] = m_roots[root].first;
+        worker.path[1] = m_roots[root].second;
+        if (!Expand(worker, cube, worker.path[0], afterFirst, 1, bound) || !Expand(worker, afterFirst, worker.path[1], afterSecond, 2, bound))
+            continue;
+
+        if (Search(worker, afterSecond, 2, bound, worker.path[1] / 3))
+            break;
+    }
+}
+
+void OptimalSolver::PrintMemoryUsage()
+{
+    m_corners.PrintMemoryUsage("Corner pattern database");
+    m_edgesFirst.PrintMemoryUsage("Edge pattern database (first edges)");
+    m_edgesLast.PrintMemoryUsage("Edge pattern database (last edges)");
+}
+
+// iterative deepening - the bound is raised by one flip, until there's a solution within it; the first
+// solution found is then optimal
+bool OptimalSolver::Solve(CubeState const& state, FlipSequence *target, SolveControl const* control)
+{
+    m_lastNodes = 0;
+    if (!IsLoaded())
+        return false;
+
+    OptimalCube cube;
+    ToOptimalCube(state, cube);
+
+    cube.distance[0] = (unsigned char)GetExactDistance(m_corners, cube, CORNER_DATABASE);
+    cube.distance[1] = (unsigned char)GetExactDistance(m_edgesFirst, cube, 0);
+    cube.distance[2] = (unsigned char)GetExactDistance(m_edgesLast, cube, STATE_EDGE_COUNT - m_edgeCount);
+
+    int estimate = max(cube.distance[0], max(cube.distance[1], cube.distance[2]));
+    if (estimate == 0)
+        return true;
+
+    int threads = (m_threadCount > 0) ? m_threadCount : (int)std::thread::hardware_concurrency();
+    if (threads < 1)
+        threads = 1;
+
+    std::vector<OptimalWorker> workers(threads);
+    for (int i = 0; i < threads; i++)
+    {
+        workers[i].control = (i == 0) ? control : nullptr;
+        workers[i].untilPoll = SOLVE_CONTROL_INTERVAL;
+    }
+    m_cancelled = false;
+
+    for (int bound = estimate; bound <= OPTIMAL_DEPTH_MAX; bound++)
+    {
+        m_found = false;
+        m_nextRoot = 0;
+        for (int i = 0; i < threads; i++)
+            workers[i].nodes = 0;
+
+        // the shallowest bound is not worth splitting (and the root subtrees start at depth 2)
+        if (bound < 2)
+            Search(workers[0], cube, 0, bound, -1);
+        else
+        {
+            std::vector<std::thread> pool;
+            for (int i = 1; i < threads; i++)
+                pool.push_back(std::thread(&OptimalSolver::SearchRoots, this, std::ref(workers[i]), std::cref(cube), bound));
+
+            SearchRoots(workers[0], cube, bound);
+
+            for (size_t i = 0; i < pool.size(); i++)
+                pool[i].join();
+        }
+
+        for (int i = 0; i < threads; i++)
+            m_lastNodes += workers[i].nodes;
+
+        if (m_cancelled)
+            return false;
+
+        if (m_found)
+        {
+            for (size_t i = 0; i < m_solution.size(); i++)
+                target->push_back(m_solution[i]);
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,159 @@
+#ifndef RUBIK_OPTIMALSOLVER_H
+#define RUBIK_OPTIMALSOLVER_H
+
+#include <atomic>
+#include <mutex>
+#include "Singleton.h"
+#include "CubeState.h"
+#include "PatternDatabase.h"
+#include "SolveControl.h"
+
+// default count of edges in every edge pattern database
+#define OPTIMAL_EDGES_DEFAULT 6
+// minimal count of edges in edge pattern database (two databases have to cover all edges)
+#define OPTIMAL_EDGES_MIN 6
+// maximal count of edges in edge pattern database (7 edges take about 128 MB per database - 510935040 entries,
+// four of them per byte, see PATTERN_PACKING_MOD3)
+#define OPTIMAL_EDGES_MAX 7
+// no position of cube is farther than 20 flips (so called God's number)
+#define OPTIMAL_DEPTH_MAX 20
+// count of corner orientations (the last corner orientation is given by the others)
+#define CORNER_ORIENTATIONS 2187
+// count of corner permutations
+#define CORNER_PERMUTATIONS 40320
+
+// cube as seen by optimal solver - corners are kept as coordinates (rank of permutation and orientations, see
+// CubeState), so the flip is just a lookup in table; edges are kept as positions of cubies, so the pattern
+// database index of any group of edges could be computed just from their own entries
+struct OptimalCube
+{
+    // rank of corner permutation
+    unsigned short cornerPermutation;
+    // orientations of first 7 corners in base 3 (the last one is given by the others)
+    unsigned short cornerTwist;
+    // position of every edge cubie (in order of solvedPermutation)
+    unsigned char edgePosition[STATE_EDGE_COUNT];
+    // orientation of every edge cubie
+    unsigned char edgeOrient[STATE_EDGE_COUNT];
+    // exact distances in corner, first and last edge database (the databases keep them just modulo 3, so they are
+    // decoded from parent)
+    unsigned char distance[3];
+
+    // index in corner pattern database
+    unsigned int GetCornerIndex() const { return (unsigned int)cornerPermutation * CORNER_ORIENTATIONS + cornerTwist; };
+};
+
+// search state of one worker thread
+struct OptimalWorker
+{
+    // flips on the current path
+    CubeFlip path[OPTIMAL_DEPTH_MAX];
+    // count of visited nodes
+    unsigned long long nodes;
+    // control of solve - only the worker running in the calling thread has it, so the progress is reported from
+    // that thread (null for the others)
+    SolveControl const* control;
+    // count of nodes left until the next check of control
+    int untilPoll;
+};
+
+// optimal solver (Korf's algorithm) - IDA* over all 18 flips, with distance estimated by pattern databases
+// of corners and two groups of edges; the subtrees of first two flips are searched in parallel
+class OptimalSolver
+{
+    friend class Singleton<OptimalSolver>;
+    public:
+        ~OptimalSolver();
+
+        // loads pattern databases (with specified count of edges in every edge database) from directory; the
+        // missing ones are built and stored there
+        bool Init(int edgeCount, std::string const& directory);
+        // sets count of worker threads (0 = one per core)
+        void SetThreadCount(int threads) { m_threadCount = threads; };
+
+        // is the solver ready?
+        bool IsLoaded() { return m_corners.IsLoaded() && m_edgesFirst.IsLoaded() && m_edgesLast.IsLoaded(); };
+
+        // appends optimal solution of state to target; returns false, if no solution was found, or when the control
+        // (if any) cancelled the search
+        bool Solve(CubeState const& state, FlipSequence *target, SolveControl const* control = nullptr);
+        // retrieves count of nodes visited by last solve
+        unsigned long long GetLastNodeCount() { return m_lastNodes; };
+        // prints memory report lines of pattern databases
+        void PrintMemoryUsage();
+        // builds pattern database of corners into db with supplied count of threads (0 = one per core); the
+        // solver's own database is left untouched, it's meant for measuring the build
+        void BuildCornerDatabase(PatternDatabase &db, int threads);
+
+    private:
+        OptimalSolver();
+
+        // builds tables of flips on corner coordinates and edge positions
+        void InitMoveTables();
+        // converts cubie state to cube used by solver
+        void ToOptimalCube(CubeState const& state, OptimalCube &dst);
+        // performs flip on corners
+        inline void DoCornerFlip(OptimalCube const& src, CubeFlip flip, OptimalCube &dst);
+        // performs flip on edges from begin to end
+        inline void DoEdgeFlip(OptimalCube const& src, CubeFlip flip, OptimalCube &dst, int begin, int end);
+
+        // index of edges (starting with first) in edge database
+        unsigned int GetEdgeIndex(OptimalCube const& cube, int first);
+        // sets cube, whose edges (starting with first) have supplied index (other edges are left untouched)
+        void SetEdgeIndex(OptimalCube &cube, unsigned int index, int first);
+
+        // index of cube in database of corners, or of edges starting with first
+        inline unsigned int GetIndex(OptimalCube const& cube, int first);
+        // performs flip just on cubies of database
+        inline void DoDatabaseFlip(OptimalCube const& src, CubeFlip flip, OptimalCube &dst, int first);
+        // exact distance of cube in database
+        int GetExactDistance(PatternDatabase const& db, OptimalCube const& cube, int first);
+
+        // loads, or builds and stores pattern database of corners, or of edges starting with first
+        void InitDatabase(PatternDatabase &db, std::string const& filename, int first);
+        // builds pattern database by breadth first search over its indexes
+        void BuildDatabase(PatternDatabase &db, int first, int threads);
+
+        // performs flip during search (new node is at depth); returns false, when the new node is pruned
+        inline bool Expand(OptimalWorker &worker, OptimalCube const& cube, CubeFlip flip, OptimalCube &next, int depth, int bound);
+        // searches for solution within bound, starting after the path of depth flips; returns true, when
+        // solution was found (by this, or by other worker)
+        bool Search(OptimalWorker &worker, OptimalCube const& cube, int depth, int bound, int lastFace);
+        // worker thread searching root subtrees until there's none left
+        void SearchRoots(OptimalWorker &worker, OptimalCube const& cube, int bound);
+
+        // rank of corner permutation after flip
+        unsigned short m_cornerPermutationMove[CORNER_PERMUTATIONS][FLIP_MAX];
+        // corner orientations after flip
+        unsigned short m_cornerTwistMove[CORNER_ORIENTATIONS][FLIP_MAX];
+        // position of edge after flip
+        unsigned char m_edgePositionMove[FLIP_MAX][STATE_EDGE_COUNT];
+        // orientation change of edge after flip (by its position before flip)
+        unsigned char m_edgeFlipMove[FLIP_MAX][STATE_EDGE_COUNT];
+
+        // pattern databases
+        PatternDatabase m_corners, m_edgesFirst, m_edgesLast;
+        // count of edges in edge databases
+        int m_edgeCount;
+        // count of worker threads
+        int m_threadCount;
+
+        // root subtrees (pairs of first flips) to be searched
+        std::vector<std::pair<CubeFlip, CubeFlip> > m_roots;
+        // next root subtree to be searched
+        std::atomic<unsigned int> m_nextRoot;
+        // solution was found in current bound
+        std::atomic<bool> m_found;
+        // the search was cancelled (by control of solve)
+        std::atomic<bool> m_cancelled;
+        // guards the solution
+        std::mutex m_solutionLock;
+        // solution found
+        std::vector<CubeFlip> m_solution;
+        // count of nodes visited by last solve
+        unsigned long long m_lastNodes;
+};
+
+#define sOptimalSolver Singleton<OptimalSolver>::instance()
+
+#endif
@@ -0,0 +1,200 @@
+#include "Global.h"
+#include "PatternDatabase.h"
+
+#include <fstream>
+#include <cstring>
+#include <thread>
+
+PatternDatabase::PatternDatabase()
+{
+    m_table = nullptr;
+    m_size = 0;
+    m_packing = PATTERN_PACKING_NIBBLE;
+}
+
+size_t PatternDatabase::GetMemorySize(unsigned int size, PatternPacking packing)
+{
+    size_t perByte = 8 / packing;
+    return ((size_t)size + perByte - 1) / perByte;
+}
+
+void PatternDatabase::Create(unsigned int size)
+{
+    m_file.Close();
+    m_size = size;
+    m_packing = GetPackingForSize(size);
+
+    // all bits set = unreached entry, regardless of packing
+    m_memoryTable.assign(GetMemorySize(size, m_packing), 0xFF);
+    m_table = &m_memoryTable[0];
+}
+
+// every entry is owned by byte shared with neighbouring entries, so the bytes are accessed as atomics during build
+// (they have the same size and representation on every supported compiler)
+static_assert(sizeof(std::atomic<unsigned char>) == sizeof(unsigned char), "atomic byte has to be plain byte");
+
+int PatternDatabase::GetStoredAtomic(unsigned int index) const
+{
+    unsigned char entry = ((std::atomic<unsigned char>*)m_table)[index >> (m_packing == PATTERN_PACKING_NIBBLE ? 1 : 2)].load(std::memory_order_relaxed);
+    return (entry >> GetShift(index)) & GetMask();
+}
+
+bool PatternDatabase::SetIfUnreached(unsigned int index, int distance)
+{
+    std::atomic<unsigned char> &entry = ((std::atomic<unsigned char>*)&m_memoryTable[0])[index >> (m_packing == PATTERN_PACKING_NIBBLE ? 1 : 2)];
+    unsigned int shift = GetShift(index);
+    unsigned char value = (unsigned char)((distance % GetModulus()) << shift);
+
+    unsigned char current = entry.load(std::memory_order_relaxed);
+    do
+    {
+        // some other thread was faster
+        if (((current >> shift) & GetMask()) != GetMask())
+            return false;
+    }
+    while (!entry.compare_exchange_weak(current, (unsigned char)((current & ~(GetMask() << shift)) | value), std::memory_order_relaxed));
+
+    return true;
+}
+
+// the level is expanded from its entries to unreached neighbours, but when there are less unreached entries than
+// entries in current level, it's faster to look for unreached ones, which have a neighbour in current level; with
+// modulo 3 packing, the forward scan expands also some of older levels, but their neighbours are all reached
+//
+// the entries of next level differ from current level even modulo 3, so the threads may scan the table while
+// the others are setting next level - every entry gets the same distance regardless of order, and it's set just
+// once, so the table and level counts are the same for any count of threads
+unsigned int PatternDatabase::BuildLevel(PatternNeighbours const& neighbours, int distance, bool backward, std::atomic<unsigned int> &nextChunk)
+{
+    unsigned int found[PATTERN_NEIGHBOURS_MAX];
+    unsigned int levelCount = 0;
+    int current = (int)(distance % GetModulus());
+
+    unsigned int chunkCount = (m_size + PATTERN_BUILD_CHUNK - 1) / PATTERN_BUILD_CHUNK;
+    for (unsigned int chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+    {
+        unsigned int end = (chunk + 1) * PATTERN_BUILD_CHUNK;
+        if (end > m_size)
+            end = m_size;
+
+        for (unsigned int index = chunk * PATTERN_BUILD_CHUNK; index < end; index++)
+        {
+            int stored = GetStoredAtomic(index);
+            if (backward ? stored != GetUnreachedValue() : stored != current)
+                continue;
+
+            int count = neighbours(index, found);
+            for (int i = 0; i < count; i++)
+            {
+                if (backward)
+                {
+                    if (GetStoredAtomic(found[i]) == current)
+                    {
+                        if (SetIfUnreached(index, distance + 1))
+                            levelCount++;
+                        break;
+                    }
+                }
+                else if (SetIfUnreached(found[i], distance + 1))
+                    levelCount++;
+            }
+        }
+    }
+
+    return levelCount;
+}
+
+void PatternDatabase::Build(unsigned int solvedIndex, PatternNeighbours const& neighbours, int maxDistance, int threads)
+{
+    if (threads <= 0)
+        threads = (int)std::thread::hardware_concurrency();
+    if (threads < 1)
+        threads = 1;
+
+    Set(solvedIndex, 0);
+
+    unsigned int reached = 1, levelCount = 1;
+    for (int distance = 0; levelCount > 0 && distance < maxDistance; distance++)
+    {
+        bool backward = (m_size - reached) < levelCount;
+
+        std::atomic<unsigned int> nextChunk(0);
+        std::vector<unsigned int> counts(threads, 0);
+        std::vector<std::thread> pool;
+        for (int i = 1; i < threads; i++)
+            pool.push_back(std::thread([&, i]() { counts[i] = BuildLevel(neighbours, distance, backward, nextChunk); }));
+
+        counts[0] = BuildLevel(neighbours, distance, backward, nextChunk);
+
+        levelCount = 0;
+        for (int i = 0; i < threads; i++)
+        {
+            if (i > 0)
+                pool[i - 1].join();
+            levelCount += counts[i];
+        }
+
+        reached += levelCount;
+    }
+}
+
+bool PatternDatabase::IsEqual(PatternDatabase const& other) const
+{
+    return m_size == other.m_size && m_packing == other.m_packing && IsLoaded() && other.IsLoaded()
+        && memcmp(m_table, other.m_table, GetMemorySize()) == 0;
+}
+
+bool PatternDatabase::Load(std::string const& filename, unsigned int size)
+{
+    if (!m_file.Open(filename.c_str()))
+        return false;
+
+    PatternPacking packing = GetPackingForSize(size);
+
+    const PatternDatabaseHeader* header = (const PatternDatabaseHeader*)m_file.GetData();
+    if (m_file.GetSize() < sizeof(PatternDatabaseHeader) || header->magic != PATTERN_DATABASE_MAGIC || header->version != PATTERN_DATABASE_VERSION
+        || header->size != size || header->packing != (unsigned int)packing
+        || m_file.GetSize() != sizeof(PatternDatabaseHeader) + GetMemorySize(size, packing))
+    {
+        m_file.Close();
+        return false;
+    }
+
+    std::vector<unsigned char>().swap(m_memoryTable);
+    m_table = (const unsigned char*)m_file.GetData() + sizeof(PatternDatabaseHeader);
+    m_size = size;
+    m_packing = packing;
+
+    return true;
+}
+
+bool PatternDatabase::Store(std::string const& filename)
+{
+    PatternDatabaseHeader header;
+    header.magic = PATTERN_DATABASE_MAGIC;
+    header.version = PATTERN_DATABASE_VERSION;
+    header.size = m_size;
+    header.packing = (unsigned int)m_packing;
+
+    ofstream f;
+    f.open(filename.c_str(), ios::out | ios::binary);
+    if (!f.fail() && f.is_open())
+    {
+        f.write((const char*)&header, sizeof(PatternDatabaseHeader));
+        f.write((const char*)&m_memoryTable[0], m_memoryTable.size());
+        f.close();
+
+        if (!f.fail() && Load(filename, m_size))
+            return true;
+    }
+
+    cerr << "Could not store pattern database to " << filename << ", using it from memory" << endl;
+
+    return false;
+}
+
+void PatternDatabase::PrintMemoryUsage(std::string const& name) const
+{
+    cout << "- " << name << ": " << (double)GetMemorySize() / (1024.0 * 1024.0) << " MB (" << m_size << " entries, "
+        << (m_packing == PATTERN_PACKING_NIBBLE ? "4 bits" : "2 bits, modulo 3") << (m_file.IsOpen() ? ", mapped" : ", in memory") << ")" << endl;
+}
@@ -0,0 +1,141 @@
+#ifndef RUBIK_PATTERNDATABASE_H
+#define RUBIK_PATTERNDATABASE_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <functional>
+#include "MappedFile.h"
+
+// tables with at most this count of entries are small enough to keep exact distances (4 bits per entry),
+// the larger ones keep just distance modulo 3 (2 bits per entry)
+#define PATTERN_DATABASE_NIBBLE_MAX (1U << 24)
+// identifier of pattern database file ("RPDB")
+#define PATTERN_DATABASE_MAGIC 0x42445052
+// version of pattern database file format
+#define PATTERN_DATABASE_VERSION 2
+// maximal count of neighbours of one entry (all 18 flips)
+#define PATTERN_NEIGHBOURS_MAX 18
+// count of entries scanned by build thread at once (multiple of 4, so no byte is shared by two chunks)
+#define PATTERN_BUILD_CHUNK 65536
+
+// how are the distances stored (value is count of bits per entry)
+enum PatternPacking
+{
+    PATTERN_PACKING_MOD3 = 2,       // distance modulo 3, exact distance is decoded from distance of neighbour
+    PATTERN_PACKING_NIBBLE = 4      // exact distance (up to 14, the value 15 is shared with unreached entries)
+};
+
+// pattern database file header - it's followed by packed distances
+struct PatternDatabaseHeader
+{
+    unsigned int magic;
+    unsigned int version;
+    unsigned int size;
+    unsigned int packing;
+};
+
+// fills indexes of neighbours of entry (positions one flip away), returns their count; it's called from multiple
+// threads at once during build
+typedef std::function<int(unsigned int index, unsigned int* neighbours)> PatternNeighbours;
+
+// table of distances to solved cube of some part of cube (i.e. corners only); the meaning of index is up to the
+// one, who builds it; the table is built in memory, then stored to file and memory mapped
+//
+// large tables store distance modulo 3 - the distances of neighbours differ at most by one, so when the exact
+// distance of one neighbour is known, the other one is one of three consecutive values, and modulo 3 says which
+class PatternDatabase
+{
+    public:
+        PatternDatabase();
+
+        // allocates table of size entries in memory (all of them unreached), to be built
+        void Create(unsigned int size);
+        // maps table from file, if the file is valid table of size entries
+        bool Load(std::string const& filename, unsigned int size);
+        // builds created table by breadth first search from solved entry, up to maxDistance; every level is split
+        // among threads (0 = one per core)
+        void Build(unsigned int solvedIndex, PatternNeighbours const& neighbours, int maxDistance, int threads);
+        // stores built table to file and maps it from there; when it could not be stored, the table stays
+        // in memory
+        bool Store(std::string const& filename);
+
+        // is there any table?
+        bool IsLoaded() const { return m_table != nullptr; };
+        // retrieves count of entries
+        unsigned int GetSize() const { return m_size; };
+        // retrieves packing of entries
+        PatternPacking GetPacking() const { return m_packing; };
+        // retrieves memory occupied by entries (in bytes)
+        size_t GetMemorySize() const { return GetMemorySize(m_size, m_packing); };
+        // prints memory report line of table
+        void PrintMemoryUsage(std::string const& name) const;
+        // does the table contain the same entries as other one?
+        bool IsEqual(PatternDatabase const& other) const;
+
+        // has the entry been reached by build?
+        bool IsReached(unsigned int index) const { return GetStored(index) != GetUnreachedValue(); };
+        // could the entry be in supplied distance? (with modulo 3 packing, the distances lower by multiple of 3
+        // are stored the same way)
+        bool IsAtDistance(unsigned int index, int distance) const { return GetStored(index) == (int)(distance % GetModulus()); };
+        // retrieves exact distance of entry, given exact distance of its neighbour (with nibble packing, the stored
+        // distance is exact, so the neighbour does not matter)
+        int GetDistance(unsigned int index, int neighbourDistance) const
+        {
+            int stored = GetStored(index);
+            if (m_packing == PATTERN_PACKING_NIBBLE)
+                return stored;
+            // one of neighbourDistance - 1, neighbourDistance, neighbourDistance + 1
+            return neighbourDistance - 1 + (stored - neighbourDistance % 3 + 4) % 3;
+        };
+        // sets distance of entry (only while building)
+        void Set(unsigned int index, int distance)
+        {
+            unsigned int shift = GetShift(index);
+            unsigned char &entry = m_memoryTable[index >> (m_packing == PATTERN_PACKING_NIBBLE ? 1 : 2)];
+            entry = (unsigned char)((entry & ~(GetMask() << shift)) | ((distance % GetModulus()) << shift));
+        };
+
+    private:
+        // scans chunks of table for one level of build, until there's none left; returns count of entries set
+        unsigned int BuildLevel(PatternNeighbours const& neighbours, int distance, bool backward, std::atomic<unsigned int> &nextChunk);
+        // retrieves value stored for entry, while other threads may write the table
+        int GetStoredAtomic(unsigned int index) const;
+        // sets distance of entry, unless it's already reached; safe against other threads writing the same byte,
+        // returns true, when the entry was set by this call
+        bool SetIfUnreached(unsigned int index, int distance);
+
+        // bytes needed to store size entries with packing
+        static size_t GetMemorySize(unsigned int size, PatternPacking packing);
+        // retrieves packing used for table of size entries
+        static PatternPacking GetPackingForSize(unsigned int size) { return (size <= PATTERN_DATABASE_NIBBLE_MAX) ? PATTERN_PACKING_NIBBLE : PATTERN_PACKING_MOD3; };
+
+        // bit mask of one entry
+        unsigned int GetMask() const { return (1U << m_packing) - 1; };
+        // modulus of stored distance (16 = exact)
+        unsigned int GetModulus() const { return (m_packing == PATTERN_PACKING_NIBBLE) ? 16 : 3; };
+        // value of entries not reached (yet) by build
+        int GetUnreachedValue() const { return (int)GetMask(); };
+        // position of entry within its byte
+        unsigned int GetShift(unsigned int index) const { return (m_packing == PATTERN_PACKING_NIBBLE) ? (index & 1) * 4 : (index & 3) * 2; };
+        // retrieves value stored for entry
+        int GetStored(unsigned int index) const
+        {
+            if (m_packing == PATTERN_PACKING_NIBBLE)
+                return (m_table[index >> 1] >> ((index & 1) * 4)) & 0xF;
+            return (m_table[index >> 2] >> ((index & 3) * 2)) & 0x3;
+        };
+
+        // mapped table file
+        MappedFile m_file;
+        // table in memory (while building, or when it could not be stored)
+        std::vector<unsigned char> m_memoryTable;
+        // packed distances (the entry with lower index in lower bits)
+        const unsigned char* m_table;
+        // count of entries
+        unsigned int m_size;
+        // packing of entries
+        PatternPacking m_packing;
+};
+
+#endif
@@ -1,305 +1,343 @@
-#ifndef RUBIK_RUBIK_H
-#define RUBIK_RUBIK_H
-
-#include <queue>
-#include "bigint.h"
-
-#include "Singleton.h"
-
-// size of cube in graphics units
-#define CUBE_SIZE 18.0f
-// size of one atom (small cube)
-#define ATOM_SIZE CUBE_SIZE/3.0f
-// spacing between atoms
-#define ATOM_SPACING 0.2f
-// default animation timer
-#define ANIM_TIMER_DEFAULT 200
-
-// stored static reference to mesh manipulator to simplify working with meshes
-static IMeshManipulator* meshManipulator = nullptr;
-
-// state permutation string array length
-#define STATE_STRING_LENGTH 20
-
-// all possible colors
-enum RubikColor
-{
-    CL_RED = 0,
-    CL_GREEN = 1,
-    CL_BLUE = 2,
-    CL_YELLOW = 3,
-    CL_WHITE = 4,
-    CL_ORANGE = 5,
-
-    CL_NONE = 6,    // "no color", typically initial state or non-visible side
-    CL_COUNT = 6
-};
-
-// each color's ARGB representation (index matches value from enumerator RubikColor)
-static SColor rubikColorMap[] = {
-    { 255, 200,   0,   0 },
-    { 255,   0, 200,   0 },
-    { 255,   0,   0, 200 },
-    { 255, 200, 200,   0 },
-    { 255, 255, 255, 255 },
-    { 255, 207,  64,   0 },
-    { 255,   0,   0,   0 }
-};
-
-// color code used for each color (index matches value from enumerator RubikColor)
-static char rubikColorCode[] = { 'R', 'G', 'B', 'Y', 'W', 'O', '-' };
-
-// translates color code to RubikColor enum value
-static RubikColor getColorForCode(char code)
-{
-    for (int i = 0; i < CL_COUNT; i++)
-        if (code == rubikColorCode[i])
-            return (RubikColor)i;
-    return CL_NONE;
-}
-
-// all possible cube faces
-enum CubeFace
-{
-    CF_UP = 0,
-    CF_DOWN = 1,
-    CF_BACK = 2,
-    CF_FRONT = 3,
-    CF_RIGHT = 4,
-    CF_LEFT = 5,
-
-    CF_BEGIN = CF_UP,
-    CF_END = CF_LEFT + 1,
-    CF_COUNT = CF_END
-};
-
-// face codes for each cube face (index matches value from enumerator CubeFace)
-static char rubikFaceCode[] = { 'U', 'D', 'B', 'F', 'R', 'L' };
-
-static std::string solvedPermutation[] = { "UF", "UR", "UB", "UL", "DF", "DR", "DB", "DL", "FR", "FL", "BR", "BL", "UFR", "URB", "UBL", "ULF", "DRF", "DFL", "DLB", "DBR" };
-
-// this will then depend on user input (these are default values)
-static CubeFace colorFaceMap[] = {
-    /* CL_RED */    CF_UP,
-    /* CL_GREEN */  CF_FRONT,
-    /* CL_BLUE */   CF_LEFT,
-    /* CL_YELLOW */ CF_RIGHT,
-    /* CL_WHITE */  CF_DOWN,
-    /* CL_ORANGE */ CF_BACK
-};
-
-// XYZ offsets of faces relative to cube fixed point ("position"), index matches value from enum CubeFace
-static vector3df cubeFaceOffset[] = {
-    { 0,                    ATOM_SIZE,           0 },
-    { 0,                    0,                   0 },
-    { 0,                    ATOM_SIZE / 2.0f,   ATOM_SIZE / 2.0f },
-    { 0,                    ATOM_SIZE / 2.0f,  -ATOM_SIZE / 2.0f },
-    { ATOM_SIZE / 2.0f,     ATOM_SIZE / 2.0f, 0 },
-    { -ATOM_SIZE / 2.0f,    ATOM_SIZE / 2.0f, 0 }
-};
-
-// XYZ rotation of every cube face (index matches value from enum CubeFace)
-static vector3df cubeFaceRotation[] = {
-    { 0, 0, 0 },
-    { -180.0f, 0, 0 },
-    { 90.0f, 0.0f, 0.0f },
-    { -90.0f, 0.0f, 0.0f },
-    { 0.0f, 0.0f, -90.0f },
-    { 0.0f, 0.0f, 90.0f }
-};
-
-class RubikCube;
-
-// structure of cube face
-struct CubeAtomFace
-{
-    // graphics element of this atom face
-    IMeshSceneNode* meshNode;
-    // base position (at start, used for animation)
-    vector3df basePosition;
-    // base rotation (at start, used for animation)
-    vector3df baseRotation;
-    // assigned color
-    RubikColor color;
-
-    // sets color to cube face
-    void setColor(RubikColor cl);
-    // retrieves color
-    RubikColor getColor() { return color; }
-};
-
-// structure of cube atom
-struct CubeAtom
-{
-    // all faces it contains
-    CubeAtomFace* faces[CF_COUNT];
-};
-
-// half-turn metric flips
-enum CubeFlip
-{
-    FLIP_R_P = 0,
-    FLIP_R_2 = 1,
-    FLIP_R_N = 2,
-
-    FLIP_L_P = 3,
-    FLIP_L_2 = 4,
-    FLIP_L_N = 5,
-
-    FLIP_B_P = 6,
-    FLIP_B_2 = 7,
-    FLIP_B_N = 8,
-
-    FLIP_F_P = 9,
-    FLIP_F_2 = 10,
-    FLIP_F_N = 11,
-
-    FLIP_D_P = 12,
-    FLIP_D_2 = 13,
-    FLIP_D_N = 14,
-
-    FLIP_U_P = 15,
-    FLIP_U_2 = 16,
-    FLIP_U_N = 17,
-
-    FLIP_MAX = FLIP_U_N + 1,
-    FLIP_BEGIN = FLIP_R_P,
-
-    FLIP_NONE       // used just as "flag", not real turn
-};
-
-// strings representing each flip (index matches value from CubeFlip enumerator)
-static char* cubeFlipStr[] = { "R+", "R2", "R-", "L+", "L2", "L-", "B+", "B2", "B-", "F+", "F2", "F-", "D+", "D2", "D-", "U+", "U2", "U-" };
-
-// Thistletwaithe's algorithm restricts flips in each stage of cube solving
-// these are bitmasks for each of stage
-static int stageAllowedFlips[] = {
-    1 << FLIP_U_P | 1 << FLIP_D_P | 1 << FLIP_F_P | 1 << FLIP_B_P | 1 << FLIP_L_P | 1 << FLIP_R_P | 1 << FLIP_U_N | 1 << FLIP_D_N | 1 << FLIP_F_N | 1 << FLIP_B_N | 1 << FLIP_L_N | 1 << FLIP_R_N,
-    1 << FLIP_U_P | 1 << FLIP_D_P | 1 << FLIP_F_2 | 1 << FLIP_B_2 | 1 << FLIP_L_P | 1 << FLIP_R_P | 1 << FLIP_U_N | 1 << FLIP_D_N | 1 << FLIP_L_N | 1 << FLIP_R_N,
-    1 << FLIP_U_2 | 1 << FLIP_D_2 | 1 << FLIP_F_2 | 1 << FLIP_B_2 | 1 << FLIP_L_P | 1 << FLIP_R_P | 1 << FLIP_L_N | 1 << FLIP_R_N,
-    1 << FLIP_U_2 | 1 << FLIP_D_2 | 1 << FLIP_F_2 | 1 << FLIP_B_2 | 1 << FLIP_L_2 | 1 << FLIP_R_2,
-};
-
-// array of affected cubes by specific flip - index matches value from CubeFace,
-// because the only thing we want to know is permutation, and number of those permutations
-// needed to proceed specific flip is determined from enumerator value
-static int flipCubeEffect[][8] = {
-    { 0, 1, 2, 3, 0, 1, 2, 3 },    // U
-    { 4, 7, 6, 5, 4, 5, 6, 7 },    // D
-    { 0, 9, 4, 8, 0, 3, 5, 4 },    // F
-    { 2, 10, 6, 11, 2, 1, 7, 6 },  // B
-    { 3, 11, 7, 9, 3, 2, 6, 5 },   // L
-    { 1, 8, 5, 10, 1, 0, 4, 7 },   // R
-};
-
-// retrieves flip for supplied string identifier
-static CubeFlip getFlipForStr(char* str)
-{
-    for (int i = 0; i < FLIP_MAX; i++)
-    {
-        if (strcmp(str, cubeFlipStr[i]) == 0)
-            return (CubeFlip)i;
-    }
-
-    return FLIP_NONE;
-}
-
-// retrieves string representing current flip
-static char* getStrForFlip(CubeFlip fl)
-{
-    if (fl < FLIP_MAX)
-        return cubeFlipStr[fl];
-    return nullptr;
-}
-
-// rubik's cube class
-class RubikCube
-{
-    friend class Singleton<RubikCube>;
-    public:
-        ~RubikCube();
-
-        // loads cube from file
-        bool LoadFromFile(char* filename);
-
-        // renders cube and 2D drawing
-        void Render();
-
-        // creates cube and its faces, assigns default values
-        void BuildCube(ISceneManager* scene, IVideoDriver* videoDriver);
-        // retrieves atom at specified position
-        CubeAtom* GetAtom(int x, int y, int z);
-
-        // performs flip; may propagate changes to cache (parameter draw)
-        void DoFlip(CubeFlip flip, bool draw);
-
-        // generates random sequence of flips
-        void Scramble(std::list<CubeFlip> *target);
-        // generate solution to current state
-        void Solve(std::list<CubeFlip> *target);
-
-        // processes flip sequence, instantly or animated (pushed to queue)
-        void ProceedFlipSequence(std::list<CubeFlip> *source, bool animate);
-
-        // determines, if there are some flips in queue
-        bool IsFlipSequenceInProgress() { return !m_flipQueue.empty(); };
-
-        // prints cube to console
-        void PrintOut();
-
-        // updates timing of flip animation
-        void UpdateFlipTiming(int howmuch) { if (m_flipTiming + howmuch >= 100 && m_flipTiming + howmuch <= 5000) m_flipTiming += howmuch; };
-        // retrieves limit of flip animation
-        int GetFlipTiming() { return m_flipTiming; };
-
-    private:
-        // private constructor, only friend class could create this class instance
-        RubikCube();
-
-        // atom storage
-        CubeAtom* m_cubeAtoms[3][3][3];
-        // cube cache by faces
-        RubikColor m_cubeCache[CF_COUNT][3][3];
-        // stored textures for faces
-        ITexture* m_faceTexture, *m_faceMiniTexture;
-        // value indicating in which solving stage are we right now
-        unsigned char m_solveStage;
-        // timing to proceed flips
-        int m_flipTiming;
-
-        // flip actually being progressed
-        CubeFlip m_toProgress;
-        // start of counter (ms)
-        unsigned int m_progressStart;
-        // queue of flips to be done
-        std::queue<CubeFlip> m_flipQueue;
-
-        // sets cube atom to internal array
-        void SetCubeAtom(int x, int y, int z, CubeAtom* atom);
-        // builds cube atom, its faces, etc.
-        CubeAtom* BuildCubeAtom(ISceneManager* scene, IVideoDriver* videoDriver, vector3df basePosition, vector3di cubeOffset);
-        // builds face of cube atom
-        CubeAtomFace* BuildFace(ISceneManager* scene, IVideoDriver* videoDriver, CubeFace side, vector3df basePosition);
-        // caches cube to internal array
-        void CacheCube();
-        // restores internal array to cube visually
-        void RestoreCacheCube();
-
-        // retrieves hash of current state, regarding current solving stage
-        bigint GetStateHash(bigint &state);
-        // converts cube configuration to permutation table
-        void ConvertToPermutationTable(std::vector<std::string> &dstList);
-        // retrieves code of edge (permutation)
-        char* GetEdgeCode(int x, int y, int z, CubeFace frst, CubeFace scnd);
-        // retrieves code for corner (permutation)
-        char* GetCornerCode(int x, int y, int z, CubeFace frst, CubeFace scnd, CubeFace thrd);
-        // performs flip on linearized cube state
-        bigint DoLinearFlip(int move, bigint state);
-
-        // circulary swaps four elements
-        void AtomCircularSwap(int ax, int ay, int az, CubeFace a, int bx, int by, int bz, CubeFace b, int cx, int cy, int cz, CubeFace c, int dx, int dy, int dz, CubeFace d, bool reverse = false);
-};
-
-#define sCube Singleton<RubikCube>::instance()
-
-#endif
+#ifndef RUBIK_RUBIK_H
+#define RUBIK_RUBIK_H
+
+#include <queue>
+#include <unordered_map>
+#include "bigint.h"
+
+#include "Singleton.h"
+#include "FlipSequence.h"
+#include "CubeState.h"
+#include "FlipScheduler.h"
+#include "SolveStages.h"
+#include "SolveControl.h"
+
+// size of cube in graphics units
+#define CUBE_SIZE 18.0f
+// size of one atom (small cube)
+#define ATOM_SIZE CUBE_SIZE/3.0f
+// spacing between atoms
+#define ATOM_SPACING 0.2f
+// default animation timer
+#define ANIM_TIMER_DEFAULT 200
+// minimal animation timer (the fastest playback)
+#define ANIM_TIMER_MIN 1
+// maximal animation timer (the slowest playback)
+#define ANIM_TIMER_MAX 5000
+
+// default maximal depth of cached backward (solved side) search in every solving stage
+#define BACKWARD_CACHE_DEPTH_DEFAULT 7
+// move stored in search record of state, where the search started (nothing led there)
+#define SEARCH_NO_MOVE 0xFF
+
+// stored static reference to mesh manipulator to simplify working with meshes
+static IMeshManipulator* meshManipulator = nullptr;
+
+// all possible colors
+enum RubikColor
+{
+    CL_RED = 0,
+    CL_GREEN = 1,
+    CL_BLUE = 2,
+    CL_YELLOW = 3,
+    CL_WHITE = 4,
+    CL_ORANGE = 5,
+
+    CL_NONE = 6,    // "no color", typically initial state or non-visible side
+    CL_COUNT = 6
+};
+
+// each color's ARGB representation (index matches value from enumerator RubikColor)
+static SColor rubikColorMap[] = {
+    { 255, 200,   0,   0 },
+    { 255,   0, 200,   0 },
+    { 255,   0,   0, 200 },
+    { 255, 200, 200,   0 },
+    { 255, 255, 255, 255 },
+    { 255, 207,  64,   0 },
+    { 255,   0,   0,   0 }
+};
+
+// color code used for each color (index matches value from enumerator RubikColor)
+static char rubikColorCode[] = { 'R', 'G', 'B', 'Y', 'W', 'O', '-' };
+
+// translates color code to RubikColor enum value
+static RubikColor getColorForCode(char code)
+{
+    for (int i = 0; i < CL_COUNT; i++)
+        if (code == rubikColorCode[i])
+            return (RubikColor)i;
+    return CL_NONE;
+}
+
+// all possible cube faces
+enum CubeFace
+{
+    CF_UP = 0,
+    CF_DOWN = 1,
+    CF_BACK = 2,
+    CF_FRONT = 3,
+    CF_RIGHT = 4,
+    CF_LEFT = 5,
+
+    CF_BEGIN = CF_UP,
+    CF_END = CF_LEFT + 1,
+    CF_COUNT = CF_END
+};
+
+// face codes for each cube face (index matches value from enumerator CubeFace)
+static char rubikFaceCode[] = { 'U', 'D', 'B', 'F', 'R', 'L' };
+
+// this will then depend on user input (these are default values)
+static CubeFace colorFaceMap[] = {
+    /* CL_RED */    CF_UP,
+    /* CL_GREEN */  CF_FRONT,
+    /* CL_BLUE */   CF_LEFT,
+    /* CL_YELLOW */ CF_RIGHT,
+    /* CL_WHITE */  CF_DOWN,
+    /* CL_ORANGE */ CF_BACK
+};
+
+// XYZ offsets of faces relative to cube fixed point ("position"), index matches value from enum CubeFace
+static vector3df cubeFaceOffset[] = {
+    { 0,                    ATOM_SIZE,           0 },
+    { 0,                    0,                   0 },
+    { 0,                    ATOM_SIZE / 2.0f,   ATOM_SIZE / 2.0f },
+    { 0,                    ATOM_SIZE / 2.0f,  -ATOM_SIZE / 2.0f },
+    { ATOM_SIZE / 2.0f,     ATOM_SIZE / 2.0f, 0 },
+    { -ATOM_SIZE / 2.0f,    ATOM_SIZE / 2.0f, 0 }
+};
+
+// XYZ rotation of every cube face (index matches value from enum CubeFace)
+static vector3df cubeFaceRotation[] = {
+    { 0, 0, 0 },
+    { -180.0f, 0, 0 },
+    { 90.0f, 0.0f, 0.0f },
+    { -90.0f, 0.0f, 0.0f },
+    { 0.0f, 0.0f, -90.0f },
+    { 0.0f, 0.0f, 90.0f }
+};
+
+class RubikCube;
+
+// structure of cube face
+struct CubeAtomFace
+{
+    // graphics element of this atom face
+    IMeshSceneNode* meshNode;
+    // base position (at start, used for animation)
+    vector3df basePosition;
+    // base rotation (at start, used for animation)
+    vector3df baseRotation;
+    // assigned color
+    RubikColor color;
+
+    // sets color to cube face
+    void setColor(RubikColor cl);
+    // retrieves color
+    RubikColor getColor() { return color; }
+};
+
+// structure of cube atom
+struct CubeAtom
+{
+    // all faces it contains
+    CubeAtomFace* faces[CF_COUNT];
+};
+
+// record of state reached by search
+struct SearchRecord
+{
+    // move used to get to this state
+    unsigned char move;
+    // distance from state, where the search started
+    unsigned char depth;
+};
+
+// states reached by search (by key in solving stage)
+typedef std::unordered_map<unsigned long long, SearchRecord> SearchRecordMap;
+
+// state at the frontier of search, together with its key in solving stage
+struct SearchNode
+{
+    bigint state;
+    unsigned long long key;
+};
+
+// backward part of bidirectional search in one solving stage - the backward search always starts in solved state,
+// so it is the same for every cube, and could be built just once and kept between solves
+struct BackwardCache
+{
+    BackwardCache() : depth(-1), complete(false) {};
+
+    // all states reached so far
+    SearchRecordMap records;
+    // states at the deepest level, to be able to grow the cache later
+    std::vector<SearchNode> frontier;
+    // depth of the deepest level (-1 = not built yet)
+    int depth;
+    // whole state space of stage is cached, there's nowhere to grow
+    bool complete;
+};
+
+// statistics of last solve
+struct SolveStats
+{
+    // states expanded in every stage (growth of backward search cache included)
+    unsigned long long expanded[4];
+    // time spent in every stage (in microseconds)
+    unsigned long long time[4];
+    // solution was found in opening book (no search was needed)
+    bool openingBook;
+    // solution was found by optimal solver
+    bool optimal;
+    // nodes visited by optimal solver
+    unsigned long long optimalNodes;
+    // time spent by optimal solver (in microseconds)
+    unsigned long long optimalTime;
+    // time from start of solve until the first flips were known, and until the whole solution was known (in
+    // microseconds; they are the same, when the solution is found at once, or when there are no flips)
+    unsigned long long firstMoveTime;
+    unsigned long long totalTime;
+
+    // count of expanded states in all stages
+    unsigned long long TotalExpanded() const
+    {
+        return expanded[0] + expanded[1] + expanded[2] + expanded[3];
+    }
+};
+
+// rubik's cube class
+class RubikCube
+{
+    friend class Singleton<RubikCube>;
+    public:
+        ~RubikCube();
+
+        // loads cube from file
+        bool LoadFromFile(char* filename);
+        // parses colors of faces from cube net (9 lines given by their beginnings and lengths, see LoadFromFile);
+        // returns false, if the net is not valid, with the reason in error
+        static bool ParseNet(const char* const* lines, const size_t* lengths, RubikColor net[CF_COUNT][3][3], std::string &error);
+        // converts colors of faces to cubie state (the faces are given by colors of centers) and validates it
+        static SolveResult GetNetState(RubikColor const net[CF_COUNT][3][3], CubeState &state);
+        // sets cube to supplied cubie state
+        void LoadFromState(CubeState const& state);
+
+        // renders cube and 2D drawing
+        void Render();
+
+        // creates cube and its faces, assigns default values
+        void BuildCube(ISceneManager* scene, IVideoDriver* videoDriver);
+        // retrieves atom at specified position
+        CubeAtom* GetAtom(int x, int y, int z);
+
+        // performs flip; may propagate changes to cache (parameter draw)
+        void DoFlip(CubeFlip flip, bool draw);
+
+        // generates random sequence of flips
+        void Scramble(FlipSequence *target);
+        // generate solution to current state; returns error code, when the state is not solvable (or when the control
+        // cancelled the search)
+        SolveResult Solve(FlipSequence *target, SolveControl const* control = nullptr);
+        // generates solution to supplied valid cubie state, collecting statistics to stats; it could be called from
+        // multiple threads at once, once the backward caches are grown (see GrowBackwardCaches), unless the
+        // solutions are optimal (OptimalSolver solves one cube at a time); the search gives up, when the control
+        // (if any) says so, and every solved stage is published to the control as soon as it's found
+        SolveResult SolveState(CubeState const& state, FlipSequence *target, SolveStats &stats, SolveControl const* control = nullptr);
+        // grows backward search caches of all stages to their full depth, so the solves only read them
+        void GrowBackwardCaches();
+        // converts current cube to cubie state and validates it
+        SolveResult GetState(CubeState &state);
+        // sets depth of backward search cached between solves
+        void SetBackwardCacheDepth(int depth) { m_backwardCacheDepth = depth; };
+        // retrieves depth of backward search cached between solves
+        int GetBackwardCacheDepth() { return m_backwardCacheDepth; };
+        // retrieves statistics of last solve
+        SolveStats const& GetLastSolveStats() { return m_lastSolveStats; };
+        // prints statistics of last solve to console
+        void PrintLastSolveStats();
+        // sets whether the solutions should be optimal (using OptimalSolver), or found by Thistlethwaite's algorithm
+        void SetOptimal(bool optimal) { m_optimal = optimal; };
+        // are the solutions optimal?
+        bool IsOptimal() { return m_optimal; };
+
+        // processes flip sequence, instantly or animated (pushed to queue)
+        void ProceedFlipSequence(FlipSequence *source, bool animate);
+
+        // determines, if there are some flips in queue
+        bool IsFlipSequenceInProgress() { return m_flipScheduler.IsActive(); };
+
+        // prints cube to console
+        void PrintOut();
+
+        // updates timing of flip animation
+        void UpdateFlipTiming(int howmuch);
+        // retrieves limit of flip animation
+        int GetFlipTiming() { return m_flipTiming; };
+
+    private:
+        // private constructor, only friend class could create this class instance
+        RubikCube();
+
+        // atom storage
+        CubeAtom* m_cubeAtoms[3][3][3];
+        // cube cache by faces
+        RubikColor m_cubeCache[CF_COUNT][3][3];
+        // stored textures for faces
+        ITexture* m_faceTexture, *m_faceMiniTexture;
+        // timing to proceed flips
+        int m_flipTiming;
+
+        // scheduler of animated flips
+        FlipScheduler m_flipScheduler;
+        // flips finished during last frame (kept here to avoid allocations every frame)
+        std::vector<CubeFlip> m_finishedFlips;
+
+        // cached backward search of every solving stage
+        BackwardCache m_backwardCache[4];
+        // maximal depth to which the backward search is cached
+        int m_backwardCacheDepth;
+        // statistics of last solve
+        SolveStats m_lastSolveStats;
+        // solve optimally (see SetOptimal)
+        bool m_optimal;
+
+        // sets cube atom to internal array
+        void SetCubeAtom(int x, int y, int z, CubeAtom* atom);
+        // builds cube atom, its faces, etc.
+        CubeAtom* BuildCubeAtom(ISceneManager* scene, IVideoDriver* videoDriver, vector3df basePosition, vector3di cubeOffset);
+        // builds face of cube atom
+        CubeAtomFace* BuildFace(ISceneManager* scene, IVideoDriver* videoDriver, CubeFace side, vector3df basePosition);
+        // caches cube to internal array
+        void CacheCube();
+        // restores internal array to cube visually
+        void RestoreCacheCube();
+        // moves and rotates faces of layer affected by flip to match supplied progress (0 = base position)
+        void AnimateFlip(CubeFlip flip, float progress);
+
+        // converts cube configuration to permutation table
+        void ConvertToPermutationTable(std::vector<std::string> &dstList);
+        // performs flip on linearized cube state
+        bigint DoLinearFlip(int move, bigint state);
+        // grows backward search cache of solving stage to specified depth; returns count of expanded states
+        template <int stage>
+        unsigned long long GrowBackwardCache(int depth);
+        // appends moves leading from supplied state back to the state, where the search started; returns the last state
+        // (and updates the key to match it)
+        template <int stage>
+        bigint WalkSearchRecords(SearchRecordMap &records, bigint state, unsigned long long &key, std::vector<int> &path);
+        // solves one stage of Thistlethwaite's algorithm - appends flips to target and applies them to state; returns
+        // false, when there's no path, or when the control cancelled the search
+        template <int stage>
+        bool SolveStage(bigint &currentState, FlipSequence *target, SolveStats &stats, SolveControl const* control);
+        // solves the last stage using precomputed table of distances (falls back to SolveStage<4>)
+        bool SolveFinalStage(bigint &currentState, FlipSequence *target, SolveStats &stats, SolveControl const* control);
+
+        // circulary swaps four elements
+        void AtomCircularSwap(int ax, int ay, int az, CubeFace a, int bx, int by, int bz, CubeFace b, int cx, int cy, int cz, CubeFace c, int dx, int dy, int dz, CubeFace d, bool reverse = false);
+};
+
+#define sCube Singleton<RubikCube>::instance()
+
+#endif
@@ -0,0 +1,128 @@
+#include "Global.h"
+#include "SolutionPacker.h"
+
+// the numbers are written byte by byte (little endian), so the format does not depend on platform
+static void packUInt(std::string &dst, unsigned int value)
+{
+    for (int i = 0; i < 4; i++)
+        dst += (char)((value >> (i * 8)) & 0xFF);
+}
+
+static unsigned int unpackUInt(const unsigned char* src)
+{
+    return src[0] | (src[1] << 8) | (src[2] << 16) | ((unsigned int)src[3] << 24);
+}
+
+void SolutionPacker::PackHeader(std::string &dst)
+{
+    packUInt(dst, PACKED_SOLUTION_MAGIC);
+    packUInt(dst, PACKED_SOLUTION_VERSION);
+}
+
+static void packRecordHeader(std::string &dst, unsigned int id, unsigned char count)
+{
+    packUInt(dst, id);
+    dst += (char)count;
+}
+
+void SolutionPacker::PackSolution(std::string &dst, unsigned int id, FlipSequence const& solution)
+{
+    // every solution found is far below the error mark (at most 20 flips optimal, about 50 by stages)
+    packRecordHeader(dst, id, (unsigned char)solution.size());
+
+    unsigned int bits = 0;
+    int used = 0;
+    for (FlipSequence::const_iterator itr = solution.begin(); itr != solution.end(); ++itr)
+    {
+        bits |= (unsigned int)*itr << used;
+        used += PACKED_SOLUTION_FLIP_BITS;
+
+        while (used >= 8)
+        {
+            dst += (char)(bits & 0xFF);
+            bits >>= 8;
+            used -= 8;
+        }
+    }
+
+    if (used > 0)
+        dst += (char)bits;
+}
+
+void SolutionPacker::PackError(std::string &dst, unsigned int id, SolveResult result)
+{
+    packRecordHeader(dst, id, PACKED_SOLUTION_ERROR);
+    dst += (char)result;
+}
+
+SolutionUnpacker::SolutionUnpacker(const char* data, size_t size)
+{
+    m_end = (const unsigned char*)data + size;
+    m_corrupted = false;
+
+    const unsigned char* header = (const unsigned char*)data;
+    if (size < PACKED_SOLUTION_HEADER || unpackUInt(header) != PACKED_SOLUTION_MAGIC || unpackUInt(header + 4) != PACKED_SOLUTION_VERSION)
+        m_pos = nullptr;
+    else
+        m_pos = header + PACKED_SOLUTION_HEADER;
+}
+
+bool SolutionUnpacker::Next(unsigned int &id, FlipSequence &target, SolveResult &result)
+{
+    if (!m_pos || m_pos >= m_end)
+        return false;
+
+    if (m_end - m_pos < PACKED_SOLUTION_RECORD_HEADER)
+    {
+        m_corrupted = true;
+        return false;
+    }
+
+    id = unpackUInt(m_pos);
+    int count = m_pos[4];
+    m_pos += PACKED_SOLUTION_RECORD_HEADER;
+
+    if (count == PACKED_SOLUTION_ERROR)
+    {
+        if (m_pos >= m_end)
+        {
+            m_corrupted = true;
+            return false;
+        }
+
+        result = (SolveResult)*m_pos++;
+        return true;
+    }
+
+    size_t bytes = (count * PACKED_SOLUTION_FLIP_BITS + 7) / 8;
+    if ((size_t)(m_end - m_pos) < bytes)
+    {
+        m_corrupted = true;
+        return false;
+    }
+
+    unsigned int bits = 0;
+    int available = 0;
+    for (int i = 0; i < count; i++)
+    {
+        while (available < PACKED_SOLUTION_FLIP_BITS)
+        {
+            bits |= (unsigned int)*m_pos++ << available;
+            available += 8;
+        }
+
+        unsigned int flip = bits & ((1 << PACKED_SOLUTION_FLIP_BITS) - 1);
+        bits >>= PACKED_SOLUTION_FLIP_BITS;
+        available -= PACKED_SOLUTION_FLIP_BITS;
+
+        if (flip >= FLIP_MAX)
+        {
+            m_corrupted = true;
+            return false;
+        }
+        target.push_back((CubeFlip)flip);
+    }
+
+    result = SOLVE_OK;
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef RUBIK_SOLUTIONPACKER_H
+#define RUBIK_SOLUTIONPACKER_H
+
+#include "CubeState.h"
+#include "FlipSequence.h"
+
+// identifier of packed solution file ("RSOL")
+#define PACKED_SOLUTION_MAGIC 0x4C4F5352
+// version of packed solution file format
+#define PACKED_SOLUTION_VERSION 1
+// bits per packed flip (all 18 flips fit)
+#define PACKED_SOLUTION_FLIP_BITS 5
+// move count marking record of cube, which was not solved (followed by one byte of SolveResult)
+#define PACKED_SOLUTION_ERROR 0xFF
+// size of file header (magic and version)
+#define PACKED_SOLUTION_HEADER 8
+// size of record header (cube id and move count)
+#define PACKED_SOLUTION_RECORD_HEADER 5
+
+// packed solution file starts with header - magic and version (4 bytes little endian each); it's followed by
+// records; every record starts with cube id (index of cube in batch input, 4 bytes little endian) and move count
+// (1 byte), followed by flips packed at 5 bits each (the first flip in the lowest bits), padded to whole bytes
+
+// writes solutions in packed binary format - a solution of Thistlethwaite's algorithm takes about 27 bytes,
+// instead of about 100 bytes of text
+class SolutionPacker
+{
+    public:
+        // appends file header to buffer
+        static void PackHeader(std::string &dst);
+        // appends record of solved cube to buffer
+        static void PackSolution(std::string &dst, unsigned int id, FlipSequence const& solution);
+        // appends record of cube, which could not be solved, to buffer
+        static void PackError(std::string &dst, unsigned int id, SolveResult result);
+};
+
+// reads packed solution file from memory (i.e. memory mapped file)
+class SolutionUnpacker
+{
+    public:
+        SolutionUnpacker(const char* data, size_t size);
+
+        // does the data start with valid header?
+        bool IsValid() const { return m_pos != nullptr; };
+        // is the data truncated, or corrupted? (valid only after Next returned false)
+        bool IsCorrupted() const { return m_corrupted; };
+
+        // unpacks next record - appends solution to target, or sets result to the reason, why the cube was not
+        // solved; returns false at the end of data
+        bool Next(unsigned int &id, FlipSequence &target, SolveResult &result);
+
+    private:
+        // next record
+        const unsigned char* m_pos;
+        // end of data
+        const unsigned char* m_end;
+        // the last record was not complete, or contained invalid flip
+        bool m_corrupted;
+};
+
+#endif
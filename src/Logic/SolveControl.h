@@ -0,0 +1,65 @@
+#ifndef RUBIK_SOLVECONTROL_H
+#define RUBIK_SOLVECONTROL_H
+
+#include <atomic>
+#include <functional>
+#include "FlipSequence.h"
+
+// count of states expanded between checks of SolveControl (in every stage search, and in optimal search)
+#define SOLVE_CONTROL_INTERVAL 1024
+
+// progress of running solve, as reported to SolveControl
+struct SolveProgress
+{
+    // stage of Thistlethwaite's algorithm (1-4), or 0 for optimal search
+    int stage;
+    // depth of search - sum of forward and backward depth in stage search, current bound in optimal search
+    int depth;
+    // count of states expanded so far (in current stage, or in the whole optimal search - just the calling thread's
+    // part of the current bound, the other threads do not report)
+    unsigned long long expanded;
+    // count of states at the deepest level of forward and backward search (not used by optimal search)
+    size_t forwardFrontier, backwardFrontier;
+};
+
+// called with progress of search; it's called by the thread calling the solver
+typedef std::function<void(SolveProgress const&)> SolveProgressCallback;
+// called with flips of every stage as soon as the stage is solved, so the consumer could start acting on them before
+// the whole solution is known; the stages come in order, and their flips make the solution together - stage is
+// 1-4 for Thistlethwaite's algorithm (empty stages included), or 0 for solution found at once (opening book, optimal
+// search); when the solve fails later, the stages already published stay valid, the cube just is not solved by
+// them; it's called by the thread calling the solver
+typedef std::function<void(int stage, FlipSequence const& flips)> SolveStageCallback;
+
+// limits of one solve - the search checks them regularly (see SOLVE_CONTROL_INTERVAL), and gives up when they are
+// exceeded; the progress is reported at every check, and every solved stage is published right away
+struct SolveControl
+{
+    // time (see getUSTime), when the search should give up (0 = no deadline)
+    unsigned long long deadline;
+    // cancellation token - set by anybody (other thread, signal handler, progress callback), when the search should
+    // give up (may be null)
+    std::atomic<bool> const* cancel;
+    // progress callback (may be empty)
+    SolveProgressCallback onProgress;
+    // stage callback (may be empty)
+    SolveStageCallback onStage;
+
+    SolveControl() : deadline(0), cancel(nullptr) { }
+
+    // should the search give up?
+    bool IsCancelled() const
+    {
+        return (cancel && cancel->load(std::memory_order_relaxed)) || (deadline && getUSTime() >= deadline);
+    }
+
+    // reports progress, and checks whether the search should give up
+    bool Poll(SolveProgress const& progress) const
+    {
+        if (onProgress)
+            onProgress(progress);
+        return IsCancelled();
+    }
+};
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef RUBIK_SOLVESTAGES_H
+#define RUBIK_SOLVESTAGES_H
+
+#include "bigint.h"
+#include "CubeState.h"
+
+// faces in order of linear moves (rows of flipCubeEffect, see RubikCube::DoLinearFlip)
+enum LinearFace
+{
+    LF_UP = 0,
+    LF_DOWN = 1,
+    LF_FRONT = 2,
+    LF_BACK = 3,
+    LF_LEFT = 4,
+    LF_RIGHT = 5
+};
+
+// mask of quarter turn linear moves of face (both directions; half turn is then made of two quarter turns)
+#define LINEAR_FACE_QUARTER_TURNS(face) (5 << ((face) * 3))
+// mask of half turn linear move of face
+#define LINEAR_FACE_HALF_TURN(face) (2 << ((face) * 3))
+
+// bit of stage key holding parity of corner permutation (for stages, which track it)
+#define STAGE_KEY_PARITY_BIT (1ULL << 48)
+
+// orbit of position in last stage - M, S and E slice edges, and the two corner tetrads (see stageOrbitIndex)
+static const unsigned char stageOrbit[STATE_STRING_LENGTH] = {
+    // edges
+    0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2,
+    // corners
+    3, 4, 3, 4, 4, 3, 4, 3
+};
+// count of orbits in last stage
+#define STAGE_ORBIT_COUNT 5
+
+// index of cubie within its orbit in last stage - only half turns are allowed there, so every edge stays in its
+// slice, and every corner in its tetrad; each of these orbits has 4 cubies (ordered by their index)
+static const unsigned char stageOrbitIndex[STATE_STRING_LENGTH] = {
+    // edges - M slice (UF, UB, DF, DB), S slice (UR, UL, DR, DL), E slice (FR, FL, BR, BL)
+    0, 0, 1, 1, 2, 2, 3, 3, 0, 1, 2, 3,
+    // corners - tetrads (UFR, UBL, DFL, DBR) and (URB, ULF, DRF, DLB)
+    0, 0, 1, 1, 2, 2, 3, 3
+};
+
+// properties of every stage of Thistlethwaite's algorithm - everything is known at compile time, so the search
+// of every stage is compiled separately, with move loops unrolled and key computation inlined
+// - allowedMoves: mask of linear moves allowed in stage
+// - trackParity: whether the key contains parity of corner permutation
+// - Contribution: part of state key determined by cubie at position; the key encodes only those things, we are
+//   about to solve in stage, so the rest could be almost anything (we don't care about the rest in our stage,
+//   maybe later); every position has its own bits, so the key is exact, and could be updated incrementally
+template <int stage>
+struct SolveStageTraits;
+
+// stage 1 - all quarter turns are allowed, we hash only edges (their orientation)
+template <>
+struct SolveStageTraits<1>
+{
+    enum
+    {
+        allowedMoves = LINEAR_FACE_QUARTER_TURNS(LF_UP) | LINEAR_FACE_QUARTER_TURNS(LF_DOWN) | LINEAR_FACE_QUARTER_TURNS(LF_FRONT)
+                     | LINEAR_FACE_QUARTER_TURNS(LF_BACK) | LINEAR_FACE_QUARTER_TURNS(LF_LEFT) | LINEAR_FACE_QUARTER_TURNS(LF_RIGHT)
+    };
+
+    enum { trackParity = 0 };
+
+    static inline unsigned long long Contribution(int position, int /*cubie*/, int orientation)
+    {
+        // edge orientation - 12 bits
+        return (position < STATE_EDGE_COUNT) ? ((unsigned long long)orientation << position) : 0;
+    }
+};
+
+// stage 2 - edges are oriented, so F and B quarter turns are not allowed; we hash corner orientations, and
+// middle slice edges
+template <>
+struct SolveStageTraits<2>
+{
+    enum
+    {
+        allowedMoves = LINEAR_FACE_QUARTER_TURNS(LF_UP) | LINEAR_FACE_QUARTER_TURNS(LF_DOWN) | LINEAR_FACE_HALF_TURN(LF_FRONT)
+                     | LINEAR_FACE_HALF_TURN(LF_BACK) | LINEAR_FACE_QUARTER_TURNS(LF_LEFT) | LINEAR_FACE_QUARTER_TURNS(LF_RIGHT)
+    };
+
+    enum { trackParity = 0 };
+
+    static inline unsigned long long Contribution(int position, int cubie, int orientation)
+    {
+        // whether the edge belongs to middle slice - 12 bits
+        if (position < STATE_EDGE_COUNT)
+            return (unsigned long long)(cubie / 8) << position;
+
+        // corner orientation - 8 x 2 bits
+        return (unsigned long long)orientation << (STATE_EDGE_COUNT + 2 * (position - STATE_EDGE_COUNT));
+    }
+};
+
+// stage 3 - L and R quarter turns are not allowed anymore; we hash middle, center edges, and L+R edges+corners
+// to fix parity
+template <>
+struct SolveStageTraits<3>
+{
+    enum
+    {
+        allowedMoves = LINEAR_FACE_QUARTER_TURNS(LF_UP) | LINEAR_FACE_QUARTER_TURNS(LF_DOWN) | LINEAR_FACE_HALF_TURN(LF_FRONT)
+                     | LINEAR_FACE_HALF_TURN(LF_BACK) | LINEAR_FACE_HALF_TURN(LF_LEFT) | LINEAR_FACE_HALF_TURN(LF_RIGHT)
+    };
+
+    enum { trackParity = 1 };
+
+    static inline unsigned long long Contribution(int position, int cubie, int /*orientation*/)
+    {
+        // middle strip edge, or the edge slice - 12 x 2 bits
+        if (position < STATE_EDGE_COUNT)
+            return (unsigned long long)((cubie > 7) ? 2 : (cubie & 1)) << (2 * position);
+
+        // corner tetrad - 8 x 3 bits (the parity follows at bit 48)
+        return (unsigned long long)((cubie - STATE_EDGE_COUNT) & 5) << (24 + 3 * (position - STATE_EDGE_COUNT));
+    }
+};
+
+// stage 4 - only half turns are allowed; we are now heading to complete solution, so we have to encode everything,
+// but the cubies could not leave their orbits (see stageOrbitIndex), so position within orbit is enough
+template <>
+struct SolveStageTraits<4>
+{
+    enum
+    {
+        allowedMoves = LINEAR_FACE_HALF_TURN(LF_UP) | LINEAR_FACE_HALF_TURN(LF_DOWN) | LINEAR_FACE_HALF_TURN(LF_FRONT)
+                     | LINEAR_FACE_HALF_TURN(LF_BACK) | LINEAR_FACE_HALF_TURN(LF_LEFT) | LINEAR_FACE_HALF_TURN(LF_RIGHT)
+    };
+
+    enum { trackParity = 0 };
+
+    static inline unsigned long long Contribution(int position, int cubie, int /*orientation*/)
+    {
+        // cubie within orbit - 20 x 2 bits
+        return (unsigned long long)stageOrbitIndex[cubie] << (2 * position);
+    }
+};
+
+// computes key of the whole state in stage
+template <int stage>
+inline unsigned long long getStageKey(bigint &state)
+{
+    unsigned long long key = 0;
+    for (int i = 0; i < STATE_STRING_LENGTH; i++)
+        key |= SolveStageTraits<stage>::Contribution(i, state.d[i], state.d[i + STATE_STRING_LENGTH]);
+
+    // parity of corner permutation (parity of count of inversions)
+    if (SolveStageTraits<stage>::trackParity)
+    {
+        for (int i = STATE_EDGE_COUNT; i < STATE_STRING_LENGTH; i++)
+            for (int j = i + 1; j < STATE_STRING_LENGTH; j++)
+                if (state.d[i] > state.d[j])
+                    key ^= STAGE_KEY_PARITY_BIT;
+    }
+
+    return key;
+}
+
+// updates key of state after linear move (see RubikCube::DoLinearFlip) - only the 8 cubies affected by move
+// are encoded again, so it takes constant time
+template <int stage>
+inline unsigned long long updateStageKey(unsigned long long key, int move, bigint &oldState, bigint &newState)
+{
+    int* effect = flipCubeEffect[move / 3];
+    for (int i = 0; i < 8; i++)
+    {
+        int pos = effect[i] + (i > 3) * STATE_EDGE_COUNT;
+        key ^= SolveStageTraits<stage>::Contribution(pos, oldState.d[pos], oldState.d[pos + STATE_STRING_LENGTH])
+             ^ SolveStageTraits<stage>::Contribution(pos, newState.d[pos], newState.d[pos + STATE_STRING_LENGTH]);
+    }
+
+    // quarter turn is a 4-cycle of corners, so it changes the parity (half turn is made of two of them)
+    if (SolveStageTraits<stage>::trackParity && (move % 3) != 1)
+        key ^= STAGE_KEY_PARITY_BIT;
+
+    return key;
+}
+
+#endif
@@ -0,0 +1,237 @@
+#include "Global.h"
+#include "Benchmark.h"
+#include "Rubik.h"
+#include "OpeningBook.h"
+#include "FinalStageTable.h"
+#include "OptimalSolver.h"
+#include "BatchParser.h"
+
+#include <thread>
+
+// implicit constructor
+BenchmarkHandler::BenchmarkHandler()
+{
+    m_count = 0;
+}
+
+// initialize everything needed
+bool BenchmarkHandler::Init(unsigned long long count)
+{
+    // build cube with no renderers
+    sCube->BuildCube(nullptr, nullptr);
+
+    m_count = count;
+
+    return true;
+}
+
+// prints count of items processed in supplied time (and the rate, if the time is measurable)
+static void printRate(unsigned long long count, unsigned long long time, const char* unit)
+{
+    cout << count << " " << unit << " in " << (double)time / 1000.0 << " ms";
+    if (time > 0)
+        cout << " (" << (unsigned long long)((double)count * 1000000.0 / (double)time) << " " << unit << "/s)";
+    cout << endl;
+}
+
+// builds table by one thread and by one thread per core, and reports both times; the tables have to be the same,
+// the parallel build is worthless when it depends on scheduling of threads
+static void measureTableBuild(const char* name, std::function<void(PatternDatabase&, int)> build)
+{
+    int threads = max(1, (int)std::thread::hardware_concurrency());
+    PatternDatabase single, parallel;
+
+    unsigned long long start = getUSTime();
+    build(single, 1);
+    unsigned long long singleTime = getUSTime() - start;
+
+    start = getUSTime();
+    build(parallel, threads);
+    unsigned long long parallelTime = getUSTime() - start;
+
+    cout << name << ": " << (double)singleTime / 1000.0 << " ms with 1 thread, " << (double)parallelTime / 1000.0 << " ms with "
+        << threads << (threads == 1 ? " thread (" : " threads (") << (parallel.IsEqual(single) ? "identical" : "DIFFERENT") << " tables)" << endl;
+}
+
+// parses batch from memory, the same way as mapped batch file is parsed, and reports the speed
+static void measureParsing(const char* name, std::vector<char> const& input, size_t used)
+{
+    unsigned long long start = getUSTime();
+
+    BatchParser parser(&input[0], used);
+    CubeState state;
+    SolveResult result;
+    unsigned long long cubes = 0, failed = 0;
+    while (parser.Next(state, result))
+    {
+        cubes++;
+        if (result != SOLVE_OK)
+            failed++;
+    }
+
+    unsigned long long time = getUSTime() - start;
+
+    cout << name << ": ";
+    printRate(cubes, time, "cubes");
+    if (time > 0)
+        cout << name << " throughput: " << (double)used / (double)time / 1000.0 << " GB/s" << endl;
+    if (failed > 0)
+        cout << "Failed cubes: " << failed << endl;
+}
+
+// measures parsing of random permutation strings (the same as written by generator) and of random scrambles
+static void measureBatchParsing()
+{
+    std::vector<char> input(BENCHMARK_PARSE_STATES * (STATE_TEXT_LENGTH + 1));
+    size_t used = 0;
+
+    CubeState state;
+    for (int i = 0; i < BENCHMARK_PARSE_STATES; i++)
+    {
+        state.Randomize(*sRandom);
+        used += state.WriteString(&input[used]);
+        input[used++] = '\n';
+    }
+
+    measureParsing("Batch parsing", input, used);
+
+    // every flip takes two characters and separator
+    input.resize(BENCHMARK_PARSE_STATES * BENCHMARK_SCRAMBLE_LENGTH * 3);
+    used = 0;
+    for (int i = 0; i < BENCHMARK_PARSE_STATES; i++)
+    {
+        for (int k = 0; k < BENCHMARK_SCRAMBLE_LENGTH; k++)
+        {
+            const char* flip = cubeFlipStr[sRandom->NextUInt(FLIP_MAX)];
+            input[used++] = flip[0];
+            input[used++] = flip[1];
+            input[used++] = (k + 1 < BENCHMARK_SCRAMBLE_LENGTH) ? ' ' : '\n';
+        }
+    }
+
+    measureParsing("Scramble parsing", input, used);
+}
+
+// solves requested count of random states and reports speed of solver in every stage
+void BenchmarkHandler::Run()
+{
+    CubeState state;
+    FlipSequence solution;
+
+    // the first solve builds cached part of backward search - measure it separately, so it does not affect the rest
+    state.Randomize(*sRandom);
+    sCube->LoadFromState(state);
+
+    unsigned long long start = getUSTime();
+    sCube->Solve(&solution);
+    cout << "Warm-up solve (solved side cache build): " << (double)(getUSTime() - start) / 1000.0 << " ms" << endl;
+
+    cout << "Building tables..." << endl;
+    measureTableBuild("Final stage table", [](PatternDatabase &table, int threads) { sFinalStageTable->Build(table, threads); });
+    // the other pattern databases are built the same way, and they take much longer (the optimal solver is not
+    // touched without optimal solving, its move tables would be built for nothing)
+    if (sCube->IsOptimal() && sOptimalSolver->IsLoaded())
+        measureTableBuild("Corner pattern database", [](PatternDatabase &table, int threads) { sOptimalSolver->BuildCornerDatabase(table, threads); });
+
+    measureBatchParsing();
+
+    cout << "Solving " << m_count << " random states..." << endl;
+
+    unsigned long long expanded[4] = { 0, 0, 0, 0 };
+    unsigned long long time[4] = { 0, 0, 0, 0 };
+    unsigned long long flips = 0, failed = 0;
+    unsigned long long optimalNodes = 0, optimalTime = 0;
+    unsigned long long firstMoveTime = 0, solveTime = 0;
+
+    start = getUSTime();
+
+    for (unsigned long long i = 0; i < m_count; i++)
+    {
+        state.Randomize(*sRandom);
+        sCube->LoadFromState(state);
+
+        solution.clear();
+        if (sCube->Solve(&solution) != SOLVE_OK)
+        {
+            failed++;
+            continue;
+        }
+
+        // verify the solution on cubie level, the benchmark is worthless when the solver is broken
+        state.DoFlips(solution);
+        if (!state.IsSolved())
+            failed++;
+
+        flips += solution.size();
+
+        SolveStats const& stats = sCube->GetLastSolveStats();
+        for (int s = 0; s < 4; s++)
+        {
+            expanded[s] += stats.expanded[s];
+            time[s] += stats.time[s];
+        }
+        optimalNodes += stats.optimalNodes;
+        optimalTime += stats.optimalTime;
+        firstMoveTime += stats.firstMoveTime;
+        solveTime += stats.totalTime;
+    }
+
+    unsigned long long total = getUSTime() - start;
+
+    for (int s = 0; s < 4; s++)
+    {
+        cout << "Stage " << (s + 1) << ": ";
+        printRate(expanded[s], time[s], "expansions");
+    }
+    if (optimalNodes > 0)
+    {
+        cout << "Optimal search: ";
+        printRate(optimalNodes, optimalTime, "nodes");
+    }
+
+    cout << "Total: ";
+    printRate(m_count, total, "solves");
+    if (m_count > 0)
+        cout << "Average solution length: " << (double)flips / (double)m_count << " flips" << endl;
+    // the first stage is known long before the whole solution (see SolveStageCallback)
+    if (m_count > failed)
+        cout << "Average time to first flip: " << (double)firstMoveTime / 1000.0 / (double)(m_count - failed) << " ms, whole solution: "
+            << (double)solveTime / 1000.0 / (double)(m_count - failed) << " ms" << endl;
+    if (failed > 0)
+        cout << "Failed solves: " << failed << endl;
+
+    if (!sOpeningBook->IsLoaded())
+        return;
+
+    // random states are too far for opening book, so measure it on states scrambled by book depth flips
+    cout << "Solving " << m_count << " states scrambled by " << sOpeningBook->GetDepth() << " flips using opening book..." << endl;
+
+    unsigned long long lookupTime = 0, found = 0;
+    flips = 0;
+
+    for (unsigned long long i = 0; i < m_count; i++)
+    {
+        state.SetSolved();
+        for (int f = 0; f < sOpeningBook->GetDepth(); f++)
+            state.DoFlip((CubeFlip)sRandom->NextUInt(FLIP_MAX));
+
+        solution.clear();
+        start = getUSTime();
+        bool inBook = sOpeningBook->Solve(state, &solution);
+        lookupTime += getUSTime() - start;
+
+        state.DoFlips(solution);
+        if (inBook && state.IsSolved())
+        {
+            found++;
+            flips += solution.size();
+        }
+    }
+
+    cout << "Opening book: ";
+    printRate(found, lookupTime, "solves");
+    if (found > 0)
+        cout << "Average optimal solution length: " << (double)flips / (double)found << " flips" << endl;
+    if (found < m_count)
+        cout << "Failed solves: " << (m_count - found) << endl;
+}
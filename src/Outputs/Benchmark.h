@@ -0,0 +1,27 @@
+#ifndef RUBIK_BENCHMARK_H
+#define RUBIK_BENCHMARK_H
+
+#include "Singleton.h"
+
+// count of permutation strings parsed to measure batch input parsing
+#define BENCHMARK_PARSE_STATES 200000
+// count of flips of every scramble parsed by benchmark (random states are reached by about 20 flips)
+#define BENCHMARK_SCRAMBLE_LENGTH 25
+
+class BenchmarkHandler
+{
+    friend class Singleton<BenchmarkHandler>;
+    public:
+
+        bool Init(unsigned long long count);
+        void Run();
+
+    private:
+        BenchmarkHandler();
+
+        unsigned long long m_count;
+};
+
+#define sBenchmark Singleton<BenchmarkHandler>::instance()
+
+#endif
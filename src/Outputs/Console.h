@@ -1,24 +1,30 @@
-#ifndef RUBIK_CONSOLE_H
-#define RUBIK_CONSOLE_H
-
-#include "Singleton.h"
-
-class ConsoleHandler
-{
-    friend class Singleton<ConsoleHandler>;
-    public:
-
-        bool Init();
-        void Run();
-
-    private:
-        ConsoleHandler();
-
-        bool m_printOn;
-
-        bool ProcessCommand(std::string &cmd);
-};
-
-#define sConsole Singleton<ConsoleHandler>::instance()
-
-#endif
+#ifndef RUBIK_CONSOLE_H
+#define RUBIK_CONSOLE_H
+
+#include "Singleton.h"
+#include "CubeState.h"
+
+// minimal time between two progress reports of solve (in milliseconds)
+#define CONSOLE_PROGRESS_INTERVAL 500
+
+class ConsoleHandler
+{
+    friend class Singleton<ConsoleHandler>;
+    public:
+
+        bool Init();
+        void Run();
+
+    private:
+        ConsoleHandler();
+
+        bool m_printOn;
+
+        bool ProcessCommand(std::string &cmd);
+        // solves current cube, reporting progress of search; the search could be cancelled by Ctrl+C
+        SolveResult SolveCube(FlipSequence &flist);
+};
+
+#define sConsole Singleton<ConsoleHandler>::instance()
+
+#endif
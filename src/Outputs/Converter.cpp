@@ -0,0 +1,104 @@
+#include "Global.h"
+#include "Converter.h"
+#include "SolutionPacker.h"
+#include "MappedFile.h"
+#include <fstream>
+
+// implicit constructor - empty
+ConverterHandler::ConverterHandler()
+{
+    //
+}
+
+// initialize everything needed
+bool ConverterHandler::Init(std::string &infile, std::string &outfile)
+{
+    // both files are needed - the input is binary, and the output may be really large
+    if (infile.length() == 0 || outfile.length() == 0)
+    {
+        cout << "Input and output file have to be specified, cannot continue." << endl;
+        return false;
+    }
+
+    m_inFile = std::string(infile);
+    m_outFile = std::string(outfile);
+
+    return true;
+}
+
+// converts packed solutions (see SolutionPacker) to text - the same lines as batch solving writes
+void ConverterHandler::Run()
+{
+    MappedFile in;
+    if (!in.Open(m_inFile.c_str()))
+    {
+        cerr << "File " << m_inFile << " does not exist (or it's empty)." << endl;
+        return;
+    }
+    in.AdviseSequential();
+
+    SolutionUnpacker unpacker(in.GetData(), in.GetSize());
+    if (!unpacker.IsValid())
+    {
+        cerr << "File " << m_inFile << " does not contain packed solutions." << endl;
+        return;
+    }
+
+    ofstream f;
+    f.open(m_outFile, ios::out | ios::binary);
+    // may indicate some rights failure, etc.
+    if (f.fail() || !f.is_open())
+    {
+        cerr << "Could not open file " << m_outFile << " for writing!" << endl;
+        return;
+    }
+
+    cout << "Converting packed solutions to text..." << endl;
+
+    unsigned long long start = getUSTime();
+
+    // lines are formatted to large buffer, which is flushed to file when full
+    std::string buffer;
+    buffer.reserve(CONVERTER_BUFFER_SIZE + 256);
+
+    unsigned long long count = 0;
+    unsigned int id;
+    FlipSequence solution;
+    SolveResult result;
+    while (unpacker.Next(id, solution, result))
+    {
+        // the records are written in order of input, so the lines match the input without ids
+        if (id != count)
+            cerr << "Solution of cube " << id << " found at position " << count << endl;
+
+        if (result == SOLVE_OK)
+            buffer += solution.toString(" ");
+        else
+        {
+            buffer += "ERROR: ";
+            buffer += getSolveResultStr(result);
+        }
+        buffer += '\n';
+
+        solution.clear();
+        count++;
+
+        if (buffer.size() >= CONVERTER_BUFFER_SIZE)
+        {
+            f.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+
+    f.write(buffer.data(), buffer.size());
+    f.close();
+
+    if (unpacker.IsCorrupted())
+        cerr << "File " << m_inFile << " is truncated or corrupted after " << count << " solutions." << endl;
+
+    double seconds = (double)(getUSTime() - start) / 1000000.0;
+    cout << "Converted " << count << " solutions (" << in.GetSize() << " bytes) in " << seconds << " s";
+    if (seconds > 0)
+        cout << " (" << (unsigned long long)((double)count / seconds) << " solutions/s)";
+    cout << endl;
+}
@@ -0,0 +1,26 @@
+#ifndef RUBIK_CONVERTER_H
+#define RUBIK_CONVERTER_H
+
+#include "Singleton.h"
+
+// size of output buffer of converter
+#define CONVERTER_BUFFER_SIZE (1024 * 1024)
+
+class ConverterHandler
+{
+    friend class Singleton<ConverterHandler>;
+    public:
+
+        bool Init(std::string &infile, std::string &outfile);
+        void Run();
+
+    private:
+        ConverterHandler();
+
+        std::string m_inFile;
+        std::string m_outFile;
+};
+
+#define sConverter Singleton<ConverterHandler>::instance()
+
+#endif
@@ -1,223 +1,369 @@
-#include "Global.h"
-#include "bigint.h"
-#include "Rubik.h"
-#include "Drawing.h"
-
-// empty constructor
-Drawing::Drawing()
-{
-    m_messageToShow = "";
-    m_messageShowTimer = 0;
-}
-
-// empty destructor
-Drawing::~Drawing()
-{
-    //
-}
-
-// initializes drawing
-bool Drawing::Init()
-{
-    // create display device and set some parameters
-    SIrrlichtCreationParameters params = SIrrlichtCreationParameters();
-    // TODO: some kind of config?
-    params.AntiAlias = 8;
-    params.Bits = 32;
-    params.DriverType = video::EDT_OPENGL;
-    params.WindowSize = core::dimension2d<u32>(800, 600);
-    // hook event receiver
-    params.EventReceiver = &m_eventReceiver;
-    m_irrDevice = createDeviceEx(params);
-
-    if (!m_irrDevice)
-        return false;
-
-    // create driver, scene and gui
-    m_irrDriver = m_irrDevice->getVideoDriver();
-    m_irrScene = m_irrDevice->getSceneManager();
-    m_irrGui = m_irrDevice->getGUIEnvironment();
-
-    // default camera rotation
-    m_cameraAngleX = - PI / 4.0f;
-    m_cameraAngleY = PI / 4.0f;
-
-    // add main camera
-    m_mainCamera = m_irrScene->addCameraSceneNode(0, vector3df(25, 25, -25), vector3df(0, 0, 0));
-    // update camera position by mouse position
-    updateCameraPosition();
-
-    // adds light
-    m_irrScene->addLightSceneNode(m_mainCamera);
-
-    // build cube using created scene and driver
-    sCube->BuildCube(m_irrScene, m_irrDriver);
-
-    // load font and set spacing (not kerning! bad function naming; doc. Kohout would be very angry about that)
-    m_appFont = m_irrGui->getFont(DATA_DIR "appfont.png");
-    m_appFont->setKerningWidth(-3);
-
-    return true;
-}
-
-// rendering method
-bool Drawing::Render()
-{
-    if (!m_irrDevice)
-        return false;
-
-    if (!m_irrDevice->run())
-        return false;
-
-    // clears scene
-    m_irrDriver->beginScene(true, true, SColor(255, 120, 190, 130));
-
-    // draws everything that should be there (3D)
-    m_irrScene->drawAll();
-    // renders cube
-    sCube->Render();
-
-    // print some info about controls
-    m_appFont->draw(L"CONTROL\nR\t\t\t\t\tmix up the cube\nS\t\t\t\t\tsolve\n+ -\t\t\tspeed up/down flips", rect<s32>(5, 600 - 24*5, 100, 100), SColor(255, 0, 0, 127));
-
-    // about flipping speed...
-    stringw repstr = "Flipping speed: ";
-    std::string str = std::to_string(sCube->GetFlipTiming() / 1000.0f);
-    str.erase(str.find_last_not_of('0') + 1, std::string::npos);
-    repstr += str.c_str();
-    repstr += " s";
-
-    m_appFont->draw(repstr, rect<s32>(5, 600 - 24, 100, 100), SColor(255, 0, 50, 240));
-
-    if (m_messageShowTimer > 0 && m_messageToShow.length() > 0)
-    {
-        if (getMSTimeDiff(m_messageShowTimer, getMSTime()) > 3000)
-        {
-            m_messageShowTimer = 0;
-        }
-
-        m_appFont->draw(m_messageToShow.c_str(), rect<s32>(5, 600 - 24*7, 100, 100), SColor(255, 100, 40, 40));
-    }
-
-    m_irrGui->drawAll();
-
-    m_irrDriver->endScene();
-
-    return true;
-}
-
-// updates camera position regarding stored angles
-void Drawing::updateCameraPosition()
-{
-    m_mainCamera->setPosition(vector3df(35 * cos(m_cameraAngleX) * cos(m_cameraAngleY), 35 * sin(m_cameraAngleY), 35 * sin(m_cameraAngleX) * cos(m_cameraAngleY)));
-}
-
-// callback on mouse move
-void Drawing::mouseMoveCallback(int deltaX, int deltaY)
-{
-    // when left button is down, that means, we are dragging view
-    if (m_eventReceiver.GetMouseState().LeftButtonDown)
-    {
-        m_cameraAngleX -= (float)deltaX * PI / 280.0f;
-        m_cameraAngleY += (float)deltaY * PI / 280.0f;
-
-        updateCameraPosition();
-    }
-}
-
-// shows message on screen to let user know about something
-void Drawing::showMessage(char* message)
-{
-    m_messageToShow = std::string(message);
-    m_messageShowTimer = getMSTime();
-}
-
-// catches events from irrlicht engine
-bool EventReceiver::OnEvent(const SEvent& event)
-{
-    // mouse state should be remembered to determine several things
-    if (event.EventType == irr::EET_MOUSE_INPUT_EVENT)
-    {
-        switch (event.MouseInput.Event)
-        {
-            // left button pressed
-            case EMIE_LMOUSE_PRESSED_DOWN:
-                MouseState.LeftButtonDown = true;
-                break;
-            // left button released
-            case EMIE_LMOUSE_LEFT_UP:
-                MouseState.LeftButtonDown = false;
-                break;
-            // the mouse was moved
-            case EMIE_MOUSE_MOVED:
-                sDrawing->mouseMoveCallback(event.MouseInput.X - MouseState.Position.X, event.MouseInput.Y - MouseState.Position.Y);
-                MouseState.Position.X = event.MouseInput.X;
-                MouseState.Position.Y = event.MouseInput.Y;
-                break;
-            default:
-                break;
-        }
-    }
-    // key events
-    else if (event.EventType == irr::EET_KEY_INPUT_EVENT && event.KeyInput.PressedDown)
-    {
-        switch (event.KeyInput.Key)
-        {
-            // R - scramble cube
-            case KEY_KEY_R:
-            {
-                if (sCube->IsFlipSequenceInProgress())
-                    break;
-
-                cout << "Randomly mixing up cube:" << endl;
-                std::list<CubeFlip> fliplist;
-                sCube->Scramble(&fliplist);
-                sCube->ProceedFlipSequence(&fliplist, true);
-                break;
-            }
-            // S - solve cube
-            case KEY_KEY_S:
-            {
-                if (sCube->IsFlipSequenceInProgress())
-                    break;
-
-                cout << "Finding solution..." << endl;
-                std::list<CubeFlip> fliplist;
-                sCube->Solve(&fliplist);
-                // if no solution found, we can't do anything (the list would be empty)
-                if (fliplist.empty())
-                {
-                    cout << "No solution found" << endl;
-                    sDrawing->showMessage("No solution found");
-                }
-                else
-                {
-                    cout << "Solving cube:" << endl;
-                    sCube->ProceedFlipSequence(&fliplist, true);
-                }
-                break;
-            }
-            // minus means "slow down"
-            case KEY_MINUS:
-            case KEY_SUBTRACT:
-            {
-                sCube->UpdateFlipTiming(+100);
-                break;
-            }
-            // plus means "faster!"
-            case KEY_PLUS:
-            case KEY_ADD:
-            {
-                sCube->UpdateFlipTiming(-100);
-                break;
-            }
-        }
-    }
-    // log messages - we don't use logs for now!
-    else if (event.EventType == irr::EET_LOG_TEXT_EVENT)
-    {
-        return true;
-    }
-
-    return false;
-}
+#include "Global.h"
+#include "bigint.h"
+#include "Rubik.h"
+#include "Drawing.h"
+
+// empty constructor
+Drawing::Drawing() : m_solveEvents(DRAWING_SOLVE_QUEUE_SIZE)
+{
+    m_messageToShow = "";
+    m_messageShowTimer = 0;
+    m_solving = false;
+    m_solveCancel = false;
+    m_solveFlips = 0;
+}
+
+// empty destructor
+Drawing::~Drawing()
+{
+    //
+}
+
+// initializes drawing
+bool Drawing::Init()
+{
+    // create display device and set some parameters
+    SIrrlichtCreationParameters params = SIrrlichtCreationParameters();
+    // TODO: some kind of config?
+    params.AntiAlias = 8;
+    params.Bits = 32;
+    params.DriverType = video::EDT_OPENGL;
+    params.WindowSize = core::dimension2d<u32>(800, 600);
+    // hook event receiver
+    params.EventReceiver = &m_eventReceiver;
+    m_irrDevice = createDeviceEx(params);
+
+    if (!m_irrDevice)
+        return false;
+
+    // create driver, scene and gui
+    m_irrDriver = m_irrDevice->getVideoDriver();
+    m_irrScene = m_irrDevice->getSceneManager();
+    m_irrGui = m_irrDevice->getGUIEnvironment();
+
+    // default camera rotation
+    m_cameraAngleX = - PI / 4.0f;
+    m_cameraAngleY = PI / 4.0f;
+
+    // add main camera
+    m_mainCamera = m_irrScene->addCameraSceneNode(0, vector3df(25, 25, -25), vector3df(0, 0, 0));
+    // update camera position by mouse position
+    updateCameraPosition();
+
+    // adds light
+    m_irrScene->addLightSceneNode(m_mainCamera);
+
+    // build cube using created scene and driver
+    sCube->BuildCube(m_irrScene, m_irrDriver);
+
+    // load font and set spacing (not kerning! bad function naming; doc. Kohout would be very angry about that)
+    m_appFont = m_irrGui->getFont(DATA_DIR "appfont.png");
+    m_appFont->setKerningWidth(-3);
+
+    return true;
+}
+
+// rendering method
+bool Drawing::Render()
+{
+    if (!m_irrDevice)
+        return false;
+
+    if (!m_irrDevice->run())
+    {
+        // the window was closed, nobody waits for the solution
+        stopSolving();
+        return false;
+    }
+
+    // pick up progress and solution of solving thread
+    processSolveEvents();
+
+    // clears scene
+    m_irrDriver->beginScene(true, true, SColor(255, 120, 190, 130));
+
+    // draws everything that should be there (3D)
+    m_irrScene->drawAll();
+    // renders cube
+    sCube->Render();
+
+    // print some info about controls
+    m_appFont->draw(L"CONTROL\nR\t\t\t\t\tmix up the cube\nS\t\t\t\t\tsolve\nEsc\t\t\tcancel solving\n+ -\t\t\tspeed up/down flips", rect<s32>(5, 600 - 24*6, 100, 100), SColor(255, 0, 0, 127));
+
+    // about flipping speed...
+    stringw repstr = "Flipping speed: ";
+    std::string str = std::to_string(sCube->GetFlipTiming() / 1000.0f);
+    str.erase(str.find_last_not_of('0') + 1, std::string::npos);
+    repstr += str.c_str();
+    repstr += " s";
+
+    m_appFont->draw(repstr, rect<s32>(5, 600 - 24, 100, 100), SColor(255, 0, 50, 240));
+
+    if (m_messageShowTimer > 0 && m_messageToShow.length() > 0)
+    {
+        if (getMSTimeDiff(m_messageShowTimer, getMSTime()) > 3000)
+        {
+            m_messageShowTimer = 0;
+        }
+
+        m_appFont->draw(m_messageToShow.c_str(), rect<s32>(5, 600 - 24*7, 100, 100), SColor(255, 100, 40, 40));
+    }
+
+    m_irrGui->drawAll();
+
+    m_irrDriver->endScene();
+
+    return true;
+}
+
+// the cube is converted to cubie state right here, so the solving thread does not touch the cube at all - the cube
+// could not change meanwhile anyway, since mixing and solving are refused while solving
+void Drawing::startSolving()
+{
+    CubeState state;
+    SolveResult result = sCube->GetState(state);
+    if (result != SOLVE_OK)
+    {
+        std::string msg = std::string("Cannot be solved: ") + getSolveResultStr(result);
+        cout << msg << endl;
+        showMessage((char*)msg.c_str());
+        return;
+    }
+
+    cout << "Finding solution..." << endl;
+    showMessage("Solving... (Esc to cancel)");
+
+    m_solving = true;
+    m_solveCancel = false;
+    m_solveFlips = 0;
+    m_solveThread = std::thread(&Drawing::solveState, this, state);
+}
+
+void Drawing::solveState(CubeState state)
+{
+    unsigned int lastReport = getMSTime();
+
+    // progress reports are dropped, when the render thread does not keep up - the next one comes soon
+    SolveControl control;
+    control.cancel = &m_solveCancel;
+    control.onProgress = [this, &lastReport](SolveProgress const& progress)
+    {
+        if (getMSTimeDiff(lastReport, getMSTime()) < DRAWING_SOLVE_PROGRESS_INTERVAL)
+            return;
+        lastReport = getMSTime();
+
+        DrawingSolveEvent event;
+        event.type = SOLVE_EVENT_PROGRESS;
+        event.progress = progress;
+        event.result = SOLVE_OK;
+        m_solveEvents.TryPush(event);
+    };
+    // the stages are never dropped, the animation starts with the first one
+    control.onStage = [this](int stage, FlipSequence const& flips)
+    {
+        DrawingSolveEvent event;
+        event.type = SOLVE_EVENT_STAGE;
+        memset(&event.progress, 0, sizeof(SolveProgress));
+        event.progress.stage = stage;
+        event.result = SOLVE_OK;
+        event.flips = flips;
+        pushSolveEvent(event);
+    };
+
+    SolveStats stats;
+    memset(&stats, 0, sizeof(SolveStats));
+
+    FlipSequence solution;
+    DrawingSolveEvent event;
+    event.type = SOLVE_EVENT_DONE;
+    event.result = sCube->SolveState(state, &solution, stats, &control);
+    pushSolveEvent(event);
+}
+
+void Drawing::pushSolveEvent(DrawingSolveEvent const& event)
+{
+    while (!m_solveEvents.TryPush(event))
+        std::this_thread::yield();
+}
+
+void Drawing::processSolveEvents()
+{
+    DrawingSolveEvent event;
+    while (m_solving && m_solveEvents.TryPop(event))
+    {
+        if (event.type == SOLVE_EVENT_PROGRESS)
+        {
+            std::string msg = "Solving - ";
+            if (event.progress.stage == 0)
+                msg += "optimal search, bound " + std::to_string((long long)event.progress.depth);
+            else
+                msg += "stage " + std::to_string((long long)event.progress.stage);
+            msg += ", " + std::to_string(event.progress.expanded) + " states (Esc to cancel)";
+            showMessage((char*)msg.c_str());
+            continue;
+        }
+
+        // the flips of stage follow the previous ones right away, even while the next stage is being searched
+        if (event.type == SOLVE_EVENT_STAGE)
+        {
+            if (event.flips.empty())
+                continue;
+
+            if (m_solveFlips == 0)
+                cout << "Solving cube:" << endl;
+            m_solveFlips += event.flips.size();
+            sCube->ProceedFlipSequence(&event.flips, true);
+            continue;
+        }
+
+        // the solving thread is done
+        m_solveThread.join();
+        m_solving = false;
+
+        // the stages animated so far stay there, the cube is just not solved by them
+        if (event.result == SOLVE_CANCELLED)
+        {
+            cout << "Solving cancelled" << endl;
+            showMessage("Solving cancelled");
+        }
+        // if no solution found, we can't do anything (the list would be empty)
+        else if (event.result != SOLVE_OK)
+        {
+            std::string msg = std::string("Cannot be solved: ") + getSolveResultStr(event.result);
+            cout << msg << endl;
+            showMessage((char*)msg.c_str());
+        }
+        else if (m_solveFlips == 0)
+        {
+            cout << "Already solved" << endl;
+            showMessage("Already solved");
+        }
+        else
+            showMessage("Solved");
+    }
+}
+
+void Drawing::stopSolving()
+{
+    if (!m_solving)
+        return;
+
+    m_solveCancel = true;
+
+    // the solving thread could be waiting for room in queue to report the end
+    DrawingSolveEvent event;
+    while (!m_solveEvents.TryPop(event) || event.type != SOLVE_EVENT_DONE)
+        std::this_thread::yield();
+
+    m_solveThread.join();
+    m_solving = false;
+}
+
+// updates camera position regarding stored angles
+void Drawing::updateCameraPosition()
+{
+    m_mainCamera->setPosition(vector3df(35 * cos(m_cameraAngleX) * cos(m_cameraAngleY), 35 * sin(m_cameraAngleY), 35 * sin(m_cameraAngleX) * cos(m_cameraAngleY)));
+}
+
+// callback on mouse move
+void Drawing::mouseMoveCallback(int deltaX, int deltaY)
+{
+    // when left button is down, that means, we are dragging view
+    if (m_eventReceiver.GetMouseState().LeftButtonDown)
+    {
+        m_cameraAngleX -= (float)deltaX * PI / 280.0f;
+        m_cameraAngleY += (float)deltaY * PI / 280.0f;
+
+        updateCameraPosition();
+    }
+}
+
+// shows message on screen to let user know about something
+void Drawing::showMessage(char* message)
+{
+    m_messageToShow = std::string(message);
+    m_messageShowTimer = getMSTime();
+}
+
+// catches events from irrlicht engine
+bool EventReceiver::OnEvent(const SEvent& event)
+{
+    // mouse state should be remembered to determine several things
+    if (event.EventType == irr::EET_MOUSE_INPUT_EVENT)
+    {
+        switch (event.MouseInput.Event)
+        {
+            // left button pressed
+            case EMIE_LMOUSE_PRESSED_DOWN:
+                MouseState.LeftButtonDown = true;
+                break;
+            // left button released
+            case EMIE_LMOUSE_LEFT_UP:
+                MouseState.LeftButtonDown = false;
+                break;
+            // the mouse was moved
+            case EMIE_MOUSE_MOVED:
+                sDrawing->mouseMoveCallback(event.MouseInput.X - MouseState.Position.X, event.MouseInput.Y - MouseState.Position.Y);
+                MouseState.Position.X = event.MouseInput.X;
+                MouseState.Position.Y = event.MouseInput.Y;
+                break;
+            default:
+                break;
+        }
+    }
+    // key events
+    else if (event.EventType == irr::EET_KEY_INPUT_EVENT && event.KeyInput.PressedDown)
+    {
+        switch (event.KeyInput.Key)
+        {
+            // R - scramble cube
+            case KEY_KEY_R:
+            {
+                if (sCube->IsFlipSequenceInProgress() || sDrawing->isSolving())
+                    break;
+
+                cout << "Randomly mixing up cube:" << endl;
+                FlipSequence fliplist;
+                sCube->Scramble(&fliplist);
+                sCube->ProceedFlipSequence(&fliplist, true);
+                break;
+            }
+            // S - solve cube
+            case KEY_KEY_S:
+            {
+                if (sCube->IsFlipSequenceInProgress() || sDrawing->isSolving())
+                    break;
+
+                sDrawing->startSolving();
+                break;
+            }
+            // Escape - cancel solving
+            case KEY_ESCAPE:
+            {
+                sDrawing->cancelSolve();
+                break;
+            }
+            // minus means "slow down"
+            case KEY_MINUS:
+            case KEY_SUBTRACT:
+            {
+                sCube->UpdateFlipTiming(+100);
+                break;
+            }
+            // plus means "faster!"
+            case KEY_PLUS:
+            case KEY_ADD:
+            {
+                sCube->UpdateFlipTiming(-100);
+                break;
+            }
+        }
+    }
+    // log messages - we don't use logs for now!
+    else if (event.EventType == irr::EET_LOG_TEXT_EVENT)
+    {
+        return true;
+    }
+
+    return false;
+}
@@ -1,64 +1,119 @@
-#ifndef RUBIK_DRAWING_H
-#define RUBIK_DRAWING_H
-
-#include "Singleton.h"
-
-#define sDrawing Singleton<Drawing>::instance()
-
-class RubikCube;
-
-class EventReceiver : public IEventReceiver
-{
-    public:
-        EventReceiver() { }
-
-        struct SMouseState
-        {
-            core::position2di Position;
-            bool LeftButtonDown;
-            SMouseState() : LeftButtonDown(false) { }
-        } MouseState;
-
-        virtual bool OnEvent(const SEvent& event);
-
-        const SMouseState & GetMouseState(void) const { return MouseState; }
-
-    private:
-        //
-};
-
-class Drawing
-{
-    friend class Singleton<Drawing>;
-    public:
-        ~Drawing();
-
-        bool Init();
-        bool Render();
-
-        IrrlichtDevice* getDevice() { return m_irrDevice; };
-        IVideoDriver* getDriver() { return m_irrDriver; };
-
-        void mouseMoveCallback(int deltaX, int deltaY);
-
-        void showMessage(char* message);
-
-    private:
-        Drawing();
-        void updateCameraPosition();
-
-        IrrlichtDevice* m_irrDevice;
-        IVideoDriver* m_irrDriver;
-        ISceneManager* m_irrScene;
-        IGUIEnvironment* m_irrGui;
-        IGUIFont* m_appFont;
-        EventReceiver m_eventReceiver;
-
-        ICameraSceneNode* m_mainCamera;
-        float m_cameraAngleX, m_cameraAngleY;
-
-        std::string m_messageToShow;
-        unsigned int m_messageShowTimer;
-};
-
-#endif
+#ifndef RUBIK_DRAWING_H
+#define RUBIK_DRAWING_H
+
+#include <atomic>
+#include <thread>
+#include "Singleton.h"
+#include "CubeState.h"
+#include "SolveControl.h"
+#include "SpscQueue.h"
+
+#define sDrawing Singleton<Drawing>::instance()
+
+// minimal time between two progress reports of solving thread (in milliseconds)
+#define DRAWING_SOLVE_PROGRESS_INTERVAL 50
+// count of reports of solving thread, which could wait for render thread
+#define DRAWING_SOLVE_QUEUE_SIZE 64
+
+// kinds of reports of solving thread
+enum DrawingSolveEventType
+{
+    SOLVE_EVENT_PROGRESS = 0,   // the search goes on (progress is valid)
+    SOLVE_EVENT_STAGE = 1,      // stage was solved (progress.stage and flips of stage are valid)
+    SOLVE_EVENT_DONE = 2        // the solve is over (result is valid), nothing else will come
+};
+
+// report of solving thread, passed to render thread
+struct DrawingSolveEvent
+{
+    DrawingSolveEventType type;
+    SolveProgress progress;
+    SolveResult result;
+    FlipSequence flips;
+};
+
+typedef SpscQueue<DrawingSolveEvent> DrawingSolveQueue;
+
+class RubikCube;
+
+class EventReceiver : public IEventReceiver
+{
+    public:
+        EventReceiver() { }
+
+        struct SMouseState
+        {
+            core::position2di Position;
+            bool LeftButtonDown;
+            SMouseState() : LeftButtonDown(false) { }
+        } MouseState;
+
+        virtual bool OnEvent(const SEvent& event);
+
+        const SMouseState & GetMouseState(void) const { return MouseState; }
+
+    private:
+        //
+};
+
+class Drawing
+{
+    friend class Singleton<Drawing>;
+    public:
+        ~Drawing();
+
+        bool Init();
+        bool Render();
+
+        IrrlichtDevice* getDevice() { return m_irrDevice; };
+        IVideoDriver* getDriver() { return m_irrDriver; };
+
+        void mouseMoveCallback(int deltaX, int deltaY);
+
+        void showMessage(char* message);
+
+        // starts solving current cube in solving thread - the window is rendered meanwhile, the progress is shown
+        // as message, and every stage of solution is animated as soon as it arrives (see processSolveEvents)
+        void startSolving();
+        // is the cube being solved?
+        bool isSolving() { return m_solving; };
+        // cancels solve in progress (the solving thread reports it, when it gives up)
+        void cancelSolve() { m_solveCancel = true; };
+
+    private:
+        Drawing();
+        void updateCameraPosition();
+
+        // solving thread - solves supplied state, and reports to render thread
+        void solveState(CubeState state);
+        // passes report to render thread, waits while the queue is full (the render thread drains it every frame)
+        void pushSolveEvent(DrawingSolveEvent const& event);
+        // processes reports of solving thread (render thread only)
+        void processSolveEvents();
+        // cancels solve in progress, and waits for solving thread to finish (its reports are dropped)
+        void stopSolving();
+
+        IrrlichtDevice* m_irrDevice;
+        IVideoDriver* m_irrDriver;
+        ISceneManager* m_irrScene;
+        IGUIEnvironment* m_irrGui;
+        IGUIFont* m_appFont;
+        EventReceiver m_eventReceiver;
+
+        ICameraSceneNode* m_mainCamera;
+        float m_cameraAngleX, m_cameraAngleY;
+
+        std::string m_messageToShow;
+        unsigned int m_messageShowTimer;
+
+        // solve in progress (touched by render thread only), and its cancellation token
+        bool m_solving;
+        std::atomic<bool> m_solveCancel;
+        // solving thread, and its reports waiting for render thread
+        std::thread m_solveThread;
+        DrawingSolveQueue m_solveEvents;
+        // count of flips of solve in progress queued for animation so far
+        size_t m_solveFlips;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#include "Global.h"
+#include "Generator.h"
+#include "Rubik.h"
+#include <fstream>
+
+// implicit constructor
+GeneratorHandler::GeneratorHandler()
+{
+    m_count = 0;
+}
+
+// initialize everything needed
+bool GeneratorHandler::Init(unsigned long long count, std::string &outfile)
+{
+    // output file is needed - the output may be really large
+    if (outfile.length() == 0)
+    {
+        cout << "No output file specified, cannot continue." << endl;
+        return false;
+    }
+
+    m_count = count;
+    m_outFile = std::string(outfile);
+
+    return true;
+}
+
+// generates requested count of uniformly random states, one permutation string per line
+void GeneratorHandler::Run()
+{
+    ofstream f;
+    f.open(m_outFile, ios::out | ios::binary);
+    // may indicate some rights failure, etc.
+    if (f.fail() || !f.is_open())
+    {
+        cerr << "Could not open file " << m_outFile << " for writing!" << endl;
+        return;
+    }
+
+    cout << "Generating " << m_count << " random states..." << endl;
+
+    unsigned long long start = getUSTime();
+
+    // states are formatted directly to large buffer, which is flushed to file when full
+    std::vector<char> buffer(GENERATOR_BUFFER_SIZE);
+    size_t used = 0;
+
+    CubeState state;
+    for (unsigned long long i = 0; i < m_count; i++)
+    {
+        if (used + STATE_TEXT_LENGTH + 1 > buffer.size())
+        {
+            f.write(&buffer[0], used);
+            used = 0;
+        }
+
+        state.Randomize(*sRandom);
+        used += state.WriteString(&buffer[used]);
+        buffer[used++] = '\n';
+    }
+
+    f.write(&buffer[0], used);
+    f.close();
+
+    double seconds = (double)(getUSTime() - start) / 1000000.0;
+    cout << "Generated " << m_count << " states in " << seconds << " s";
+    if (seconds > 0)
+        cout << " (" << (unsigned long long)((double)m_count / seconds) << " states/s)";
+    cout << endl;
+}
@@ -0,0 +1,26 @@
+#ifndef RUBIK_GENERATOR_H
+#define RUBIK_GENERATOR_H
+
+#include "Singleton.h"
+
+// size of output buffer of generator
+#define GENERATOR_BUFFER_SIZE (1024 * 1024)
+
+class GeneratorHandler
+{
+    friend class Singleton<GeneratorHandler>;
+    public:
+
+        bool Init(unsigned long long count, std::string &outfile);
+        void Run();
+
+    private:
+        GeneratorHandler();
+
+        unsigned long long m_count;
+        std::string m_outFile;
+};
+
+#define sGenerator Singleton<GeneratorHandler>::instance()
+
+#endif
@@ -1,77 +1,283 @@
-#include "Global.h"
-#include "Quick.h"
-#include "Rubik.h"
-#include <fstream>
-
-// implicit constructor - empty
-QuickHandler::QuickHandler()
-{
-    //
-}
-
-// initialize everything needed
-bool QuickHandler::Init(std::string &infile, std::string &outfile)
-{
-    // build cube with no renderers
-    sCube->BuildCube(nullptr, nullptr);
-
-    // input file is needed
-    if (infile.length() == 0)
-    {
-        cout << "No input file specified, cannot continue." << endl;
-        return false;
-    }
-
-    // store output filename
-    m_outFile = std::string(outfile);
-
-    return true;
-}
-
-void QuickHandler::Run()
-{
-    cout << "Solving cube from input file..." << endl;
-
-    // solve the cube
-    std::list<CubeFlip> flist;
-    sCube->Solve(&flist);
-    if (!flist.empty())
-    {
-        // if output file specified, write output there
-        if (m_outFile.length() > 0)
-        {
-            // output file
-            ofstream f;
-            f.open(m_outFile);
-            // may indicate some rights failure, etc.
-            if (f.fail() || !f.is_open())
-            {
-                cerr << "Could not open file " << m_outFile << " for writing!" << endl;
-                return;
-            }
-
-            // save flips to file
-            for (std::list<CubeFlip>::iterator itr = flist.begin(); itr != flist.end(); ++itr)
-            {
-                f << getStrForFlip(*itr) << endl;
-            }
-
-            f.close();
-        }
-        else
-        {
-            // output flips to console if no output file specified
-            cout << "No output file specified, printing to console" << endl;
-            cout << "Found solution:" << endl;
-            for (std::list<CubeFlip>::iterator itr = flist.begin(); itr != flist.end(); ++itr)
-            {
-                cout << getStrForFlip(*itr) << ", ";
-            }
-            cout << "\b\b  " << endl;
-        }
-    }
-    else
-    {
-        cout << "No solution found, or cube already solved!" << endl;
-    }
-}
+#include "Global.h"
+#include "Quick.h"
+#include "Rubik.h"
+#include "BatchParser.h"
+#include "MappedFile.h"
+#include "SolutionPacker.h"
+#include <fstream>
+#include <thread>
+
+// implicit constructor
+QuickHandler::QuickHandler()
+{
+    m_batch = false;
+    m_binary = false;
+    m_threads = 0;
+}
+
+// initialize everything needed
+bool QuickHandler::Init(std::string &infile, std::string &outfile, bool batch, bool binary, int threads)
+{
+    // build cube with no renderers
+    sCube->BuildCube(nullptr, nullptr);
+
+    // input file is needed
+    if (infile.length() == 0)
+    {
+        cout << "No input file specified, cannot continue." << endl;
+        return false;
+    }
+
+    // store input and output filename
+    m_inFile = std::string(infile);
+    m_outFile = std::string(outfile);
+    m_batch = batch;
+    m_binary = binary;
+    m_threads = threads;
+
+    // binary output makes no sense on console
+    if (m_batch && m_binary && m_outFile.length() == 0)
+    {
+        cout << "No output file specified for binary solutions, cannot continue." << endl;
+        return false;
+    }
+
+    return true;
+}
+
+void QuickHandler::Run()
+{
+    if (m_batch)
+    {
+        RunBatch();
+        return;
+    }
+
+    cout << "Solving cube from input file..." << endl;
+
+    // solve the cube
+    FlipSequence flist;
+    SolveResult result = sCube->Solve(&flist);
+    sCube->PrintLastSolveStats();
+    if (!flist.empty())
+    {
+        // if output file specified, write output there
+        if (m_outFile.length() > 0)
+        {
+            // output file
+            ofstream f;
+            f.open(m_outFile);
+            // may indicate some rights failure, etc.
+            if (f.fail() || !f.is_open())
+            {
+                cerr << "Could not open file " << m_outFile << " for writing!" << endl;
+                return;
+            }
+
+            // save flips to file (the stream is flushed just once, when closed)
+            for (FlipSequence::const_iterator itr = flist.begin(); itr != flist.end(); ++itr)
+            {
+                f << getStrForFlip(*itr) << '\n';
+            }
+
+            f.close();
+        }
+        else
+        {
+            // output flips to console if no output file specified
+            cout << "No output file specified, printing to console" << endl;
+            cout << "Found solution:" << endl;
+            cout << flist.toString(", ") << endl;
+        }
+    }
+    else if (result != SOLVE_OK)
+    {
+        cout << "The cube cannot be solved: " << getSolveResultStr(result) << endl;
+    }
+    else
+    {
+        cout << "The cube is already solved!" << endl;
+    }
+}
+
+// the input is parsed directly from mapped file (see BatchParser); invalid cubes are reported with their line
+void QuickHandler::ReadBatch(BatchParser &parser, BatchQueue &work, BatchQueue &order)
+{
+    BatchBlock* block = nullptr;
+    CubeState state;
+    SolveResult result;
+    unsigned long long count = 0;
+
+    while (parser.Next(state, result))
+    {
+        if (result != SOLVE_OK)
+            cerr << "Line " << parser.GetLine() << ": " << parser.GetError() << endl;
+
+        if (!block)
+        {
+            block = new BatchBlock();
+            block->states.reserve(BATCH_BLOCK_SIZE);
+            block->results.reserve(BATCH_BLOCK_SIZE);
+            block->first = count;
+            block->solved = 0;
+            block->flips = 0;
+            block->doneFuture = block->done.get_future();
+        }
+
+        block->states.push_back(state);
+        block->results.push_back(result);
+        count++;
+
+        // the writer has to get the block first - when there are too many blocks in flight, this is where the
+        // reader waits
+        if (block->states.size() == BATCH_BLOCK_SIZE)
+        {
+            order.Push(block);
+            work.Push(block);
+            block = nullptr;
+        }
+    }
+
+    if (block)
+    {
+        order.Push(block);
+        work.Push(block);
+    }
+
+    order.Close();
+    work.Close();
+}
+
+void QuickHandler::SolveBatch(BatchQueue &work)
+{
+    BatchBlock* block;
+    FlipSequence solution;
+    SolveStats stats;
+
+    while (work.Pop(block))
+    {
+        for (size_t i = 0; i < block->states.size(); i++)
+        {
+            SolveResult result = block->results[i];
+            if (result == SOLVE_OK)
+            {
+                solution.clear();
+                memset(&stats, 0, sizeof(SolveStats));
+                result = sCube->SolveState(block->states[i], &solution, stats);
+            }
+
+            if (result == SOLVE_OK)
+            {
+                block->solved++;
+                block->flips += solution.size();
+            }
+
+            if (m_binary)
+            {
+                unsigned int id = (unsigned int)(block->first + i);
+                if (result == SOLVE_OK)
+                    SolutionPacker::PackSolution(block->output, id, solution);
+                else
+                    SolutionPacker::PackError(block->output, id, result);
+                continue;
+            }
+
+            // one line per cube, so the output could be matched with input
+            if (result == SOLVE_OK)
+                block->output += solution.toString(" ");
+            else
+            {
+                block->output += "ERROR: ";
+                block->output += getSolveResultStr(result);
+            }
+            block->output += '\n';
+        }
+
+        block->done.set_value();
+    }
+}
+
+// the reader, workers and writer (this thread) are connected by bounded queues - the writer gets the blocks in
+// order of input, and waits for each of them to be solved; the workers take whichever block is next
+void QuickHandler::RunBatch()
+{
+    MappedFile in;
+    if (!in.Open(m_inFile.c_str()))
+    {
+        cerr << "File " << m_inFile << " does not exist (or it's empty)." << endl;
+        return;
+    }
+    in.AdviseSequential();
+    BatchParser parser(in.GetData(), in.GetSize());
+
+    ofstream f;
+    std::ostream* out = &cout;
+    if (m_outFile.length() > 0)
+    {
+        f.open(m_outFile, ios::out | ios::binary);
+        if (f.fail() || !f.is_open())
+        {
+            cerr << "Could not open file " << m_outFile << " for writing!" << endl;
+            return;
+        }
+        out = &f;
+    }
+    else
+        cout << "No output file specified, printing to console" << endl;
+
+    int threads = (m_threads > 0) ? m_threads : (int)std::thread::hardware_concurrency();
+    // optimal solver solves one cube at a time (using all of its threads)
+    if (threads < 1 || sCube->IsOptimal())
+        threads = 1;
+
+    // the workers only read backward caches, so they have to be complete before they start
+    sCube->GrowBackwardCaches();
+
+    cout << "Solving cubes from input file using " << threads << " solver threads..." << endl;
+
+    unsigned long long start = getUSTime();
+
+    BatchQueue work(BATCH_BLOCKS_IN_FLIGHT), order(BATCH_BLOCKS_IN_FLIGHT);
+    std::thread reader(&QuickHandler::ReadBatch, this, std::ref(parser), std::ref(work), std::ref(order));
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; i++)
+        workers.push_back(std::thread(&QuickHandler::SolveBatch, this, std::ref(work)));
+
+    unsigned long long cubes = 0, solved = 0, flips = 0, written = 0;
+    if (m_binary)
+    {
+        std::string header;
+        SolutionPacker::PackHeader(header);
+        out->write(header.data(), header.size());
+        written += header.size();
+    }
+
+    BatchBlock* block;
+    while (order.Pop(block))
+    {
+        block->doneFuture.wait();
+        out->write(block->output.data(), block->output.size());
+        written += block->output.size();
+
+        cubes += block->states.size();
+        solved += block->solved;
+        flips += block->flips;
+        delete block;
+    }
+    out->flush();
+
+    reader.join();
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+
+    double seconds = (double)(getUSTime() - start) / 1000000.0;
+    cout << "Solved " << solved << " of " << cubes << " cubes in " << seconds << " s";
+    if (seconds > 0)
+        cout << " (" << (unsigned long long)((double)cubes / seconds) << " cubes/s)";
+    cout << endl;
+    if (solved > 0)
+        cout << "Average solution length: " << (double)flips / (double)solved << " flips" << endl;
+    cout << "Output: " << written << " bytes" << (m_binary ? " (packed)" : "") << endl;
+    if (solved < cubes)
+        cout << "Failed cubes: " << (cubes - solved) << (m_binary ? " (marked by move count 0xFF in output)" : " (marked by ERROR in output)") << endl;
+}
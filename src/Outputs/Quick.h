@@ -1,22 +1,68 @@
-#ifndef RUBIK_QUICK_H
-#define RUBIK_QUICK_H
-
-#include "Singleton.h"
-
-class QuickHandler
-{
-    friend class Singleton<QuickHandler>;
-    public:
-
-        bool Init(std::string &infile, std::string &outfile);
-        void Run();
-
-    private:
-        QuickHandler();
-
-        std::string m_outFile;
-};
-
-#define sQuickHandler Singleton<QuickHandler>::instance()
-
-#endif
+#ifndef RUBIK_QUICK_H
+#define RUBIK_QUICK_H
+
+#include <future>
+#include "Singleton.h"
+#include "CubeState.h"
+#include "BoundedQueue.h"
+
+// count of cubes in one block of batch - the blocks are passed between stages of pipeline as a whole
+#define BATCH_BLOCK_SIZE 256
+// maximal count of blocks read, but not written yet; this is what keeps the memory flat regardless of input size
+#define BATCH_BLOCKS_IN_FLIGHT 64
+
+// block of consecutive cubes of batch; it's filled by reader, solved by one of workers, and written by writer
+struct BatchBlock
+{
+    // parsed states (with result of parsing and validation)
+    std::vector<CubeState> states;
+    std::vector<SolveResult> results;
+    // index of the first cube of block in input
+    unsigned long long first;
+    // solutions, one line (or packed record, see SolutionPacker) per cube
+    std::string output;
+    // count of cubes solved, and count of flips of their solutions
+    unsigned long long solved, flips;
+
+    // fulfilled by worker, when the block is solved
+    std::promise<void> done;
+    // waited for by writer
+    std::future<void> doneFuture;
+};
+
+typedef BoundedQueue<BatchBlock*> BatchQueue;
+
+class BatchParser;
+
+class QuickHandler
+{
+    friend class Singleton<QuickHandler>;
+    public:
+
+        bool Init(std::string &infile, std::string &outfile, bool batch, bool binary, int threads);
+        void Run();
+
+    private:
+        QuickHandler();
+
+        // solves every cube of input file by pipeline of reader, solver pool and writer
+        void RunBatch();
+        // reader stage - parses input file into blocks of states, and passes them both to workers and to writer
+        // (in order of input)
+        void ReadBatch(BatchParser &parser, BatchQueue &work, BatchQueue &order);
+        // solver stage - solves blocks until there's none left
+        void SolveBatch(BatchQueue &work);
+
+        std::string m_inFile;
+        std::string m_outFile;
+        // solve every cube of input file (instead of one cube net)
+        bool m_batch;
+        // write packed binary solutions in batch mode (see SolutionPacker)
+        bool m_binary;
+        // count of solver threads in batch mode (0 = one per core)
+        int m_threads;
+};
+
+#define sQuickHandler Singleton<QuickHandler>::instance()
+
+#endif
@@ -0,0 +1,501 @@
+#include "Global.h"
+#include "Server.h"
+#include "Rubik.h"
+#include "BatchParser.h"
+#include <thread>
+#include <set>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+
+// event loop data of listening socket and of workers' event (connections have their ids, starting after them)
+#define SERVER_EVENT_LISTEN 0
+#define SERVER_EVENT_COMPLETED 1
+#define SERVER_FIRST_CONNECTION 2
+
+// set by signal handler, when the server should stop
+static volatile sig_atomic_t serverStopping = 0;
+
+static void stopServer(int)
+{
+    serverStopping = 1;
+}
+#endif
+
+// writes 4 byte little endian number to buffer
+static void appendUInt32(std::string &dst, unsigned int value)
+{
+    for (int i = 0; i < 4; i++)
+        dst += (char)((value >> (i * 8)) & 0xFF);
+}
+
+// builds response message
+static void appendResponse(std::string &dst, unsigned int id, SolveResult result, std::string const& text)
+{
+    appendUInt32(dst, (unsigned int)(SERVER_RESPONSE_HEADER + text.size()));
+    appendUInt32(dst, id);
+    dst += (char)result;
+    dst += text;
+}
+
+// reads 4 byte little endian number
+static unsigned int readUInt32(const char* src)
+{
+    const unsigned char* bytes = (const unsigned char*)src;
+    return (unsigned int)bytes[0] | ((unsigned int)bytes[1] << 8) | ((unsigned int)bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+// implicit constructor
+ServerHandler::ServerHandler()
+{
+    m_unix = false;
+    m_threads = 0;
+    m_listenFd = -1;
+    m_epollFd = -1;
+    m_eventFd = -1;
+    m_nextConnection = 0;
+    m_work = nullptr;
+    m_stopping = false;
+    m_answered = 0;
+    m_rejected = 0;
+    m_expired = 0;
+}
+
+ServerHandler::~ServerHandler()
+{
+#ifdef __linux__
+    if (m_listenFd >= 0)
+        close(m_listenFd);
+    if (m_epollFd >= 0)
+        close(m_epollFd);
+    if (m_eventFd >= 0)
+        close(m_eventFd);
+#endif
+    delete m_work;
+}
+
+// the address is taken as TCP port when it's a number, as path of Unix domain socket otherwise
+bool ServerHandler::Init(std::string const& address, int threads)
+{
+    // build cube with no renderers
+    sCube->BuildCube(nullptr, nullptr);
+
+    m_address = address;
+    m_threads = threads;
+    m_unix = (address.find_first_not_of("0123456789") != std::string::npos);
+
+#ifdef __linux__
+    if (m_unix)
+    {
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (address.length() >= sizeof(addr.sun_path))
+        {
+            cerr << "Socket path " << address << " is too long." << endl;
+            return false;
+        }
+        strcpy(addr.sun_path, address.c_str());
+
+        // the socket file is left behind by server, which did not exit cleanly
+        unlink(address.c_str());
+
+        m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (m_listenFd < 0 || bind(m_listenFd, (sockaddr*)&addr, sizeof(addr)) < 0)
+        {
+            cerr << "Could not bind socket " << address << ": " << strerror(errno) << endl;
+            return false;
+        }
+    }
+    else
+    {
+        int port = atoi(address.c_str());
+        if (port <= 0 || port > 65535)
+        {
+            cerr << "Invalid port " << address << endl;
+            return false;
+        }
+
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((unsigned short)port);
+        // loopback only, the server is meant for local services
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        m_listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int reuse = 1;
+        if (m_listenFd >= 0)
+            setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (m_listenFd < 0 || bind(m_listenFd, (sockaddr*)&addr, sizeof(addr)) < 0)
+        {
+            cerr << "Could not bind port " << port << ": " << strerror(errno) << endl;
+            return false;
+        }
+    }
+
+    if (listen(m_listenFd, SOMAXCONN) < 0)
+    {
+        cerr << "Could not listen on " << address << ": " << strerror(errno) << endl;
+        return false;
+    }
+
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_epollFd < 0 || m_eventFd < 0)
+    {
+        cerr << "Could not create event loop: " << strerror(errno) << endl;
+        return false;
+    }
+
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = SERVER_EVENT_LISTEN;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_listenFd, &ev);
+    ev.data.u64 = SERVER_EVENT_COMPLETED;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_eventFd, &ev);
+
+    m_nextConnection = SERVER_FIRST_CONNECTION;
+
+    return true;
+#else
+    cerr << "Server mode is supported only on Linux." << endl;
+    return false;
+#endif
+}
+
+void ServerHandler::SolveRequests()
+{
+    ServerRequest* request;
+    CubeState state;
+    SolveResult result;
+    FlipSequence solution;
+    SolveStats stats;
+    SolveControl control;
+    std::string text;
+
+    control.cancel = &m_stopping;
+
+    while (m_work->Pop(request))
+    {
+        // the request is parsed the same way as one record of batch
+        BatchParser parser(request->cube.data(), request->cube.size());
+        control.deadline = request->deadline;
+        text.clear();
+        // the request, which expired while waiting, is not even parsed
+        if (control.IsCancelled())
+            result = SOLVE_CANCELLED;
+        else if (!parser.Next(state, result))
+        {
+            result = SOLVE_INVALID_CUBIE;
+            text = "Empty request";
+        }
+        else if (result != SOLVE_OK)
+            text = parser.GetError();
+        else
+        {
+            solution.clear();
+            memset(&stats, 0, sizeof(SolveStats));
+            result = sCube->SolveState(state, &solution, stats, &control);
+        }
+
+        if (result == SOLVE_OK)
+            text = solution.toString(" ");
+        else if (text.empty())
+            text = getSolveResultStr(result);
+        if (result == SOLVE_CANCELLED)
+            m_expired++;
+
+        request->response.clear();
+        appendResponse(request->response, request->id, result, text);
+
+        {
+            std::unique_lock<std::mutex> lock(m_completedLock);
+            m_completed.push_back(request);
+        }
+
+#ifdef __linux__
+        unsigned long long one = 1;
+        if (write(m_eventFd, &one, sizeof(one)) < 0)
+            cerr << "Could not signal solved request: " << strerror(errno) << endl;
+#endif
+    }
+}
+
+#ifdef __linux__
+void ServerHandler::AcceptConnections()
+{
+    while (true)
+    {
+        int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+            return;
+
+        ServerConnection* conn = new ServerConnection();
+        conn->id = m_nextConnection++;
+        conn->fd = fd;
+        conn->sent = 0;
+        conn->inFlight = 0;
+        conn->readClosed = false;
+        conn->broken = false;
+        conn->events = EPOLLIN;
+
+        epoll_event ev;
+        ev.events = conn->events;
+        ev.data.u64 = conn->id;
+        epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev);
+
+        m_connections[conn->id] = conn;
+    }
+}
+
+void ServerHandler::ReadConnection(ServerConnection* conn)
+{
+    char buffer[SERVER_READ_CHUNK];
+
+    ssize_t count = read(conn->fd, buffer, sizeof(buffer));
+    if (count > 0)
+        conn->input.append(buffer, count);
+    else if (count == 0)
+        conn->readClosed = true;
+    else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        conn->broken = true;
+
+    ProcessInput(conn);
+}
+
+void ServerHandler::ProcessInput(ServerConnection* conn)
+{
+    size_t pos = 0;
+    while (conn->inFlight < SERVER_MAX_IN_FLIGHT && conn->input.size() - pos >= SERVER_LENGTH_SIZE)
+    {
+        unsigned int length = readUInt32(&conn->input[pos]);
+
+        // the stream cannot be synchronized again - the requests received so far are answered, the rest is dropped
+        if (length < SERVER_REQUEST_HEADER || length > SERVER_MAX_REQUEST)
+        {
+            cerr << "Invalid request length " << length << " on connection " << conn->id << ", closing it" << endl;
+            conn->readClosed = true;
+            conn->input.clear();
+            return;
+        }
+
+        if (conn->input.size() - pos - SERVER_LENGTH_SIZE < length)
+            break;
+
+        const char* header = &conn->input[pos + SERVER_LENGTH_SIZE];
+        unsigned int timeout = readUInt32(header + 5);
+
+        ServerRequest* request = new ServerRequest();
+        request->connection = conn->id;
+        request->id = readUInt32(header);
+        request->priority = (unsigned char)header[4];
+        request->deadline = timeout ? getUSTime() + (unsigned long long)timeout * 1000ULL : 0;
+        request->cube.assign(conn->input, pos + SERVER_LENGTH_SIZE + SERVER_REQUEST_HEADER, length - SERVER_REQUEST_HEADER);
+        pos += SERVER_LENGTH_SIZE + length;
+
+        // overloaded server answers right away - the client learns it now, not after the deadline
+        if (!m_work->TryPush(request, request->priority, request->deadline))
+        {
+            appendResponse(conn->output, request->id, SOLVE_REJECTED, getSolveResultStr(SOLVE_REJECTED));
+            m_rejected++;
+            delete request;
+            continue;
+        }
+
+        conn->inFlight++;
+    }
+
+    conn->input.erase(0, pos);
+}
+
+void ServerHandler::WriteConnection(ServerConnection* conn)
+{
+    while (conn->sent < conn->output.size())
+    {
+        ssize_t count = send(conn->fd, conn->output.data() + conn->sent, conn->output.size() - conn->sent, MSG_NOSIGNAL);
+        if (count < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                conn->broken = true;
+            return;
+        }
+        conn->sent += count;
+    }
+
+    conn->output.clear();
+    conn->sent = 0;
+}
+
+void ServerHandler::ProcessCompleted()
+{
+    unsigned long long count;
+    if (read(m_eventFd, &count, sizeof(count)) < 0)
+        return;
+
+    std::vector<ServerRequest*> completed;
+    {
+        std::unique_lock<std::mutex> lock(m_completedLock);
+        completed.swap(m_completed);
+    }
+
+    // every connection is written just once, no matter how many responses it got
+    std::set<unsigned long long> touched;
+    for (size_t i = 0; i < completed.size(); i++)
+    {
+        std::map<unsigned long long, ServerConnection*>::iterator itr = m_connections.find(completed[i]->connection);
+        if (itr != m_connections.end())
+        {
+            itr->second->output += completed[i]->response;
+            itr->second->inFlight--;
+            touched.insert(itr->first);
+            m_answered++;
+        }
+        delete completed[i];
+    }
+
+    for (std::set<unsigned long long>::iterator itr = touched.begin(); itr != touched.end(); ++itr)
+    {
+        ServerConnection* conn = m_connections[*itr];
+        // the requests waiting for free slot could be passed to workers now
+        ProcessInput(conn);
+        WriteConnection(conn);
+        UpdateConnection(conn);
+    }
+}
+
+void ServerHandler::UpdateConnection(ServerConnection* conn)
+{
+    bool writing = conn->sent < conn->output.size();
+    if (conn->broken || (conn->readClosed && conn->inFlight == 0 && !writing))
+    {
+        CloseConnection(conn);
+        return;
+    }
+
+    unsigned int events = 0;
+    if (!conn->readClosed && conn->inFlight < SERVER_MAX_IN_FLIGHT)
+        events |= EPOLLIN;
+    if (writing)
+        events |= EPOLLOUT;
+
+    if (events != conn->events)
+    {
+        epoll_event ev;
+        ev.events = events;
+        ev.data.u64 = conn->id;
+        epoll_ctl(m_epollFd, EPOLL_CTL_MOD, conn->fd, &ev);
+        conn->events = events;
+    }
+}
+
+void ServerHandler::CloseConnection(ServerConnection* conn)
+{
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, conn->fd, nullptr);
+    close(conn->fd);
+    m_connections.erase(conn->id);
+    delete conn;
+}
+#else
+void ServerHandler::AcceptConnections() { }
+void ServerHandler::ReadConnection(ServerConnection* conn) { }
+void ServerHandler::ProcessInput(ServerConnection* conn) { }
+void ServerHandler::WriteConnection(ServerConnection* conn) { }
+void ServerHandler::ProcessCompleted() { }
+void ServerHandler::UpdateConnection(ServerConnection* conn) { }
+void ServerHandler::CloseConnection(ServerConnection* conn) { }
+#endif
+
+// this thread runs the event loop, until the server is interrupted (SIGINT or SIGTERM)
+void ServerHandler::Run()
+{
+#ifdef __linux__
+    int threads = (m_threads > 0) ? m_threads : (int)std::thread::hardware_concurrency();
+    // optimal solver solves one cube at a time (using all of its threads)
+    if (threads < 1 || sCube->IsOptimal())
+        threads = 1;
+
+    // the workers only read backward caches, so they have to be complete before they start
+    sCube->GrowBackwardCaches();
+
+    m_work = new ServerQueue(SERVER_MAX_QUEUED);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; i++)
+        workers.push_back(std::thread(&ServerHandler::SolveRequests, this));
+
+    signal(SIGINT, stopServer);
+    signal(SIGTERM, stopServer);
+    signal(SIGPIPE, SIG_IGN);
+
+    cout << "Listening on " << (m_unix ? "Unix socket " : "127.0.0.1:") << m_address << " with " << threads << " solver threads" << endl;
+
+    epoll_event events[SERVER_MAX_EVENTS];
+    while (!serverStopping)
+    {
+        int count = epoll_wait(m_epollFd, events, SERVER_MAX_EVENTS, -1);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            cerr << "Event loop failed: " << strerror(errno) << endl;
+            break;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            unsigned long long data = events[i].data.u64;
+            if (data == SERVER_EVENT_LISTEN)
+                AcceptConnections();
+            else if (data == SERVER_EVENT_COMPLETED)
+                ProcessCompleted();
+            else
+            {
+                // the connection could be closed by previous event of this round
+                std::map<unsigned long long, ServerConnection*>::iterator itr = m_connections.find(data);
+                if (itr == m_connections.end())
+                    continue;
+
+                ServerConnection* conn = itr->second;
+                // hang up is reported only when both directions are closed, nothing could be sent anymore
+                if (events[i].events & (EPOLLERR | EPOLLHUP))
+                    conn->broken = true;
+                else
+                {
+                    if (events[i].events & EPOLLIN)
+                        ReadConnection(conn);
+                    if (events[i].events & EPOLLOUT)
+                        WriteConnection(conn);
+                }
+                UpdateConnection(conn);
+            }
+        }
+    }
+
+    cout << "Stopping server..." << endl;
+
+    while (!m_connections.empty())
+        CloseConnection(m_connections.begin()->second);
+
+    // the workers give up the requests already queued (their responses are just dropped)
+    m_stopping = true;
+    m_work->Close();
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+    for (size_t i = 0; i < m_completed.size(); i++)
+        delete m_completed[i];
+    m_completed.clear();
+
+    if (m_unix)
+        unlink(m_address.c_str());
+
+    cout << "Answered " << m_answered << " requests (" << m_expired << " of them expired), rejected " << m_rejected << " requests" << endl;
+#endif
+}
@@ -0,0 +1,137 @@
+#ifndef RUBIK_SERVER_H
+#define RUBIK_SERVER_H
+
+#include <mutex>
+#include <atomic>
+#include "Singleton.h"
+#include "DeadlineQueue.h"
+
+// maximal size of request (without length prefix) - cube net with request id fits easily
+#define SERVER_MAX_REQUEST 4096
+// count of requests of one connection being solved at once; when reached, the connection is not read until some
+// of them are answered
+#define SERVER_MAX_IN_FLIGHT 256
+// count of requests (of all connections) waiting for worker; when reached, new requests are rejected right away
+#define SERVER_MAX_QUEUED 1024
+// size of chunk read from connection at once
+#define SERVER_READ_CHUNK 65536
+// count of events retrieved from event loop at once
+#define SERVER_MAX_EVENTS 64
+// size of request header (request id, priority and deadline), of response header (request id and result), and
+// of length prefix of every message
+#define SERVER_REQUEST_HEADER 9
+#define SERVER_RESPONSE_HEADER 5
+#define SERVER_LENGTH_SIZE 4
+
+// request of client - it's created by event loop, solved by one of workers, and passed back with response
+struct ServerRequest
+{
+    // connection, which the request came from
+    unsigned long long connection;
+    // cube (anything, what could be one record of batch input, see BatchParser)
+    std::string cube;
+    // id of request chosen by client (the responses may come in different order)
+    unsigned int id;
+    // priority (higher is served first), and time, when the request is not worth solving anymore (see getUSTime,
+    // 0 = no deadline)
+    int priority;
+    unsigned long long deadline;
+    // the whole response message (with length prefix)
+    std::string response;
+};
+
+// client connection, owned by event loop
+struct ServerConnection
+{
+    // id of connection (see ServerHandler::m_connections), and its socket
+    unsigned long long id;
+    int fd;
+    // received data, which were not processed yet
+    std::string input;
+    // data to be sent, and count of them already sent
+    std::string output;
+    size_t sent;
+    // count of requests being solved
+    int inFlight;
+    // the client will not send anything else (the connection is closed, when everything is answered)
+    bool readClosed;
+    // the socket failed, the connection is closed as soon as possible
+    bool broken;
+    // events of event loop the connection currently waits for
+    unsigned int events;
+};
+
+typedef DeadlineQueue<ServerRequest*> ServerQueue;
+
+// solver server - it listens on Unix domain socket, or on loopback TCP port, and solves cubes for any count of
+// clients; every message is prefixed by its length (4 bytes little endian):
+//   request:  request id (4 bytes), priority (1 byte, higher is served first), deadline (4 bytes, milliseconds
+//             since the request was received, 0 = none), cube (cube net, facelet string, permutation string or
+//             scramble, as one record of batch)
+//   response: request id (4 bytes), SolveResult (1 byte), solution (flips separated by spaces) or error description
+// one event loop thread does all the reading and writing, the cubes are solved by pool of worker threads in order
+// of priority and deadline; the search gives up, when the deadline expires (SOLVE_CANCELLED), and the request is
+// rejected right away (SOLVE_REJECTED), when too many requests wait; the client could send many requests without
+// waiting for responses
+class ServerHandler
+{
+    friend class Singleton<ServerHandler>;
+    public:
+        ~ServerHandler();
+
+        // address is TCP port (listening on loopback only), or path of Unix domain socket
+        bool Init(std::string const& address, int threads);
+        void Run();
+
+    private:
+        ServerHandler();
+
+        // solver stage - solves requests until the server stops
+        void SolveRequests();
+
+        // accepts all pending connections
+        void AcceptConnections();
+        // reads chunk of data from connection, and passes complete requests to workers
+        void ReadConnection(ServerConnection* conn);
+        // passes complete requests of input to workers (up to limit of requests in flight)
+        void ProcessInput(ServerConnection* conn);
+        // sends as much of output as possible
+        void WriteConnection(ServerConnection* conn);
+        // appends responses of solved requests to their connections
+        void ProcessCompleted();
+        // updates events of connection in event loop (it's not read, when too many requests are in flight, and
+        // it waits for writable socket only with output pending); closes the connection, when it's done
+        void UpdateConnection(ServerConnection* conn);
+        // closes connection (its requests in flight are dropped, when solved)
+        void CloseConnection(ServerConnection* conn);
+
+        // address to listen on
+        std::string m_address;
+        // the address is path of Unix domain socket
+        bool m_unix;
+        // count of solver threads (0 = one per core)
+        int m_threads;
+
+        // listening socket, event loop, and event signalled by workers, when they solve something
+        int m_listenFd, m_epollFd, m_eventFd;
+        // connections by their id (the ids are never reused, so response of closed connection could not reach
+        // another one)
+        std::map<unsigned long long, ServerConnection*> m_connections;
+        unsigned long long m_nextConnection;
+
+        // requests waiting for worker
+        ServerQueue* m_work;
+        // set when the server stops - the searches in progress give up
+        std::atomic<bool> m_stopping;
+        // solved requests waiting for event loop, and its guard
+        std::vector<ServerRequest*> m_completed;
+        std::mutex m_completedLock;
+
+        // count of requests answered, rejected, and cancelled by deadline
+        unsigned long long m_answered, m_rejected;
+        std::atomic<unsigned long long> m_expired;
+};
+
+#define sServer Singleton<ServerHandler>::instance()
+
+#endif
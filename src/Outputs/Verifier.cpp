@@ -0,0 +1,278 @@
+#include "Global.h"
+#include "Verifier.h"
+#include "BatchParser.h"
+#include "SolutionPacker.h"
+#include "MappedFile.h"
+#include <thread>
+
+// implicit constructor
+VerifierHandler::VerifierHandler()
+{
+    m_threads = 0;
+    m_missingSolutions = 0;
+    m_extraSolutions = 0;
+}
+
+// initialize everything needed
+bool VerifierHandler::Init(std::string &infile, std::string &solutionfile, int threads)
+{
+    // cubes and their solutions are needed
+    if (infile.length() == 0 || solutionfile.length() == 0)
+    {
+        cout << "Input file and solution file have to be specified, cannot continue." << endl;
+        return false;
+    }
+
+    m_inFile = std::string(infile);
+    m_solutionFile = std::string(solutionfile);
+    m_threads = threads;
+
+    return true;
+}
+
+// the solutions are matched with cubes by order - text solutions are written one line per cube (the line is empty
+// for solved cube), packed ones carry index of cube as well
+void VerifierHandler::ReadBlocks(BatchParser &parser, const char* text, const char* textEnd, SolutionUnpacker* unpacker,
+    VerifyQueue &work, VerifyQueue &order)
+{
+    VerifyBlock* block = nullptr;
+    CubeState state;
+    SolveResult result;
+    FlipSequence solution;
+    SolveResult solutionResult;
+    unsigned int id;
+    unsigned long long count = 0;
+
+    while (parser.Next(state, result))
+    {
+        if (unpacker)
+        {
+            solution.clear();
+            if (!unpacker->Next(id, solution, solutionResult))
+            {
+                m_missingSolutions++;
+                continue;
+            }
+            if (id != count)
+                cerr << "Solution of cube " << id << " found at position " << count << endl;
+        }
+        else
+        {
+            if (text >= textEnd)
+            {
+                m_missingSolutions++;
+                continue;
+            }
+        }
+
+        if (!block)
+        {
+            block = new VerifyBlock();
+            block->states.reserve(VERIFY_BLOCK_SIZE);
+            block->results.reserve(VERIFY_BLOCK_SIZE);
+            block->lines.reserve(VERIFY_BLOCK_SIZE);
+            block->first = count;
+            block->solved = 0;
+            block->rejected = 0;
+            block->failed = 0;
+            block->doneFuture = block->done.get_future();
+        }
+
+        block->states.push_back(state);
+        block->results.push_back(result);
+        block->lines.push_back(parser.GetLine());
+
+        if (unpacker)
+        {
+            block->solutions.push_back(solution);
+            block->solutionResults.push_back(solutionResult);
+        }
+        else
+        {
+            const char* end = (const char*)memchr(text, '\n', textEnd - text);
+            if (!end)
+                end = textEnd;
+
+            // files written on Windows keep carriage return at the end of line
+            size_t length = (size_t)(end - text);
+            if (length > 0 && text[length - 1] == '\r')
+                length--;
+
+            block->texts.push_back(text);
+            block->lengths.push_back(length);
+            text = (end < textEnd) ? end + 1 : textEnd;
+        }
+
+        count++;
+
+        if (block->states.size() == VERIFY_BLOCK_SIZE)
+        {
+            order.Push(block);
+            work.Push(block);
+            block = nullptr;
+        }
+    }
+
+    if (block)
+    {
+        order.Push(block);
+        work.Push(block);
+    }
+
+    // whatever is left does not belong to any cube
+    if (unpacker)
+    {
+        while (unpacker->Next(id, solution, solutionResult))
+        {
+            solution.clear();
+            m_extraSolutions++;
+        }
+    }
+    else
+    {
+        while (text < textEnd)
+        {
+            const char* end = (const char*)memchr(text, '\n', textEnd - text);
+            text = end ? end + 1 : textEnd;
+            m_extraSolutions++;
+        }
+    }
+
+    order.Close();
+    work.Close();
+}
+
+// appends report line of failed cube to block
+static void reportFailure(VerifyBlock* block, size_t i, const char* reason)
+{
+    block->report += "Cube " + std::to_string((unsigned long long)(block->first + i)) + " (line "
+        + std::to_string(block->lines[i]) + "): " + reason + "\n";
+    block->failed++;
+}
+
+void VerifierHandler::VerifyBlocks(VerifyQueue &work)
+{
+    VerifyBlock* block;
+
+    while (work.Pop(block))
+    {
+        bool packed = !block->solutions.empty();
+
+        for (size_t i = 0; i < block->states.size(); i++)
+        {
+            CubeState &state = block->states[i];
+            bool valid = (block->results[i] == SOLVE_OK);
+
+            // the solver reports the reason instead of solution, when it could not solve the cube
+            bool unsolved;
+            if (packed)
+                unsolved = (block->solutionResults[i] != SOLVE_OK);
+            else
+                unsolved = (block->lengths[i] >= 6 && memcmp(block->texts[i], "ERROR:", 6) == 0);
+
+            if (unsolved)
+            {
+                if (valid)
+                    reportFailure(block, i, "valid cube was not solved");
+                else
+                    block->rejected++;
+                continue;
+            }
+
+            if (!valid)
+            {
+                reportFailure(block, i, "solution of invalid cube");
+                continue;
+            }
+
+            if (packed)
+                state.DoFlips(block->solutions[i]);
+            else if (!state.DoFlips(block->texts[i], block->lengths[i]))
+            {
+                reportFailure(block, i, "malformed solution");
+                continue;
+            }
+
+            if (state.IsSolved())
+                block->solved++;
+            else
+                reportFailure(block, i, "cube is not solved by its solution");
+        }
+
+        block->done.set_value();
+    }
+}
+
+// the reader, workers and reporting thread (this one) are connected the same way as in batch solving (see
+// QuickHandler::RunBatch)
+void VerifierHandler::Run()
+{
+    MappedFile in, solutions;
+    if (!in.Open(m_inFile.c_str()))
+    {
+        cerr << "File " << m_inFile << " does not exist (or it's empty)." << endl;
+        return;
+    }
+    if (!solutions.Open(m_solutionFile.c_str()))
+    {
+        cerr << "File " << m_solutionFile << " does not exist (or it's empty)." << endl;
+        return;
+    }
+    in.AdviseSequential();
+    solutions.AdviseSequential();
+
+    BatchParser parser(in.GetData(), in.GetSize());
+
+    // packed solutions are recognized by their header, anything else is taken as text
+    SolutionUnpacker unpacker(solutions.GetData(), solutions.GetSize());
+    bool packed = unpacker.IsValid();
+
+    int threads = (m_threads > 0) ? m_threads : (int)std::thread::hardware_concurrency();
+    if (threads < 1)
+        threads = 1;
+
+    cout << "Verifying " << (packed ? "packed" : "text") << " solutions using " << threads << " threads..." << endl;
+
+    unsigned long long start = getUSTime();
+
+    VerifyQueue work(VERIFY_BLOCKS_IN_FLIGHT), order(VERIFY_BLOCKS_IN_FLIGHT);
+    std::thread reader(&VerifierHandler::ReadBlocks, this, std::ref(parser), solutions.GetData(),
+        solutions.GetData() + solutions.GetSize(), packed ? &unpacker : nullptr, std::ref(work), std::ref(order));
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; i++)
+        workers.push_back(std::thread(&VerifierHandler::VerifyBlocks, this, std::ref(work)));
+
+    unsigned long long cubes = 0, solved = 0, rejected = 0, failed = 0;
+
+    VerifyBlock* block;
+    while (order.Pop(block))
+    {
+        block->doneFuture.wait();
+        cout << block->report;
+
+        cubes += block->states.size();
+        solved += block->solved;
+        rejected += block->rejected;
+        failed += block->failed;
+        delete block;
+    }
+
+    reader.join();
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+
+    double seconds = (double)(getUSTime() - start) / 1000000.0;
+    cout << "Verified " << cubes << " solutions in " << seconds << " s";
+    if (seconds > 0)
+        cout << " (" << (unsigned long long)((double)cubes / seconds) << " solutions/s)";
+    cout << endl;
+    cout << "Solved: " << solved << ", invalid cubes rejected: " << rejected << ", failed: " << failed << endl;
+    if (m_missingSolutions > 0)
+        cout << "Cubes without solution: " << m_missingSolutions << endl;
+    if (m_extraSolutions > 0)
+        cout << "Solutions without cube: " << m_extraSolutions << endl;
+    if (packed && unpacker.IsCorrupted())
+        cerr << "File " << m_solutionFile << " is truncated or corrupted." << endl;
+
+    cout << ((failed == 0 && m_missingSolutions == 0 && m_extraSolutions == 0) ? "All solutions are correct." : "VERIFICATION FAILED") << endl;
+}
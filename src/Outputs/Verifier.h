@@ -0,0 +1,77 @@
+#ifndef RUBIK_VERIFIER_H
+#define RUBIK_VERIFIER_H
+
+#include <future>
+#include "Singleton.h"
+#include "CubeState.h"
+#include "BoundedQueue.h"
+
+// count of cubes in one block of verification - replaying a solution takes much less time than solving, so the
+// blocks are larger than in batch solving
+#define VERIFY_BLOCK_SIZE 4096
+// maximal count of blocks read, but not reported yet
+#define VERIFY_BLOCKS_IN_FLIGHT 64
+
+// block of consecutive cubes with their solutions; it's filled by reader, verified by one of workers, and its
+// failures are reported by the calling thread
+struct VerifyBlock
+{
+    // parsed states (with result of parsing and validation), and lines of input, where they start
+    std::vector<CubeState> states;
+    std::vector<SolveResult> results;
+    std::vector<unsigned long long> lines;
+    // text solutions (lines of solution file, parsed by worker)
+    std::vector<const char*> texts;
+    std::vector<size_t> lengths;
+    // packed solutions (decoded by reader), with the reason why the cube was not solved
+    std::vector<FlipSequence> solutions;
+    std::vector<SolveResult> solutionResults;
+    // index of the first cube of block in input
+    unsigned long long first;
+    // report lines of failed cubes
+    std::string report;
+    // count of cubes solved by their solutions, of invalid cubes rejected by solver, and of failures
+    unsigned long long solved, rejected, failed;
+
+    // fulfilled by worker, when the block is verified
+    std::promise<void> done;
+    // waited for by reporting thread
+    std::future<void> doneFuture;
+};
+
+typedef BoundedQueue<VerifyBlock*> VerifyQueue;
+
+class BatchParser;
+class SolutionUnpacker;
+
+// verifies solutions of batch (text, or packed, see SolutionPacker) by replaying them on cubie level state of
+// input cubes - it does not need the cube, nor any table
+class VerifierHandler
+{
+    friend class Singleton<VerifierHandler>;
+    public:
+
+        bool Init(std::string &infile, std::string &solutionfile, int threads);
+        void Run();
+
+    private:
+        VerifierHandler();
+
+        // reader stage - parses cubes and their solutions into blocks, and passes them both to workers and to
+        // reporting thread (in order of input)
+        void ReadBlocks(BatchParser &parser, const char* text, const char* textEnd, SolutionUnpacker* unpacker,
+            VerifyQueue &work, VerifyQueue &order);
+        // worker stage - verifies blocks until there's none left
+        void VerifyBlocks(VerifyQueue &work);
+
+        std::string m_inFile;
+        std::string m_solutionFile;
+        // count of verifying threads (0 = one per core)
+        int m_threads;
+        // count of cubes without solution, and of solutions without cube
+        unsigned long long m_missingSolutions, m_extraSolutions;
+};
+
+#define sVerifier Singleton<VerifierHandler>::instance()
+
+#endif
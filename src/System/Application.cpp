@@ -1,164 +1,420 @@
-#include "Global.h"
-#include "Application.h"
-#include "Drawing.h"
-#include "Console.h"
-#include "Quick.h"
-#include "Rubik.h"
-
-#include <ctime>
-
-// set implicit values in this constructor
-Application::Application()
-{
-    m_graphicMode = true;
-}
-
-Application::~Application()
-{
-    //
-}
-
-// initialize the application with command line args
-bool Application::Init(int argc, char** argv)
-{
-    /*
-        Args:
-                -i file, --input file       - uses file as input (scrambled cube)
-                -o file, --output file      - outputs solution of input cube to this file
-                -ng, --nogui                - runs application without gui
-                -q, --quick                 - if -i and -o are specified, just processes them and exits
-    */
-
-    // some nice info
-    cout << "Rubik's Cube solver" << endl;
-    cout << "Semestral work for KIV/UIR subject of University of West Bohemia" << endl;
-    cout << "Author: Martin Ubl (A13B0453P), 2015" << endl;
-    cout << endl;
-
-    std::string infile, outfile;
-    bool nogui = false, quick = false;
-
-    // parse arguments...
-    if (argc > 1)
-    {
-        int cur = 1;
-        while (cur < argc)
-        {
-            if (std::string("-i") == argv[cur] || std::string("--input") == argv[cur])
-            {
-                // load cube configuration
-                if (argc > cur + 1)
-                {
-                    cur++;
-                    infile = argv[cur];
-                }
-            }
-            else if (std::string("-o") == argv[cur] || std::string("--output") == argv[cur])
-            {
-                // store solution to file
-                if (argc > cur + 1)
-                {
-                    cur++;
-                    outfile = argv[cur];
-                }
-            }
-            else if (std::string("-ng") == argv[cur] || std::string("--nogui") == argv[cur])
-            {
-                nogui = true;
-            }
-            else if (std::string("-q") == argv[cur] || std::string("--quick") == argv[cur])
-            {
-                quick = true;
-            }
-            else
-            {
-                cerr << "Unrecognized input parameter: " << argv[cur] << endl;
-            }
-
-            cur++;
-        }
-    }
-
-    cout << "Using settings: " << endl;
-    if (infile.length() > 0)
-        cout << "- Input file:  " << infile << endl;
-    if (outfile.length() > 0)
-        cout << "- Output file: " << outfile << endl;
-
-    cout << "- GUI:         " << (nogui ? "no" : "yes") << endl;
-    cout << "- Quick:       " << (quick ? "yes" : "no") << endl;
-
-    if (!nogui && quick)
-        cout << "Running without GUI due to -q (--quick) parameter" << endl;
-
-    cout << endl;
-
-    m_graphicMode = !nogui && !quick;
-    m_quickMode = quick;
-
-    srand((unsigned int)time(NULL));
-
-    if (m_graphicMode)
-    {
-        // init Irrlicht rendering engine, and init GUI
-        if (!sDrawing->Init())
-            return false;
-    }
-    else if (!m_quickMode)
-    {
-        // init console gui
-        if (!sConsole->Init())
-            return false;
-    }
-    else
-    {
-        // init quicksolver
-        if (!sQuickHandler->Init(infile, outfile))
-            return false;
-    }
-
-    // load cube if specified input file
-    if (infile.length() > 0)
-        sCube->LoadFromFile((char*)infile.c_str());
-
-    return true;
-}
-
-int Application::Run()
-{
-    int frames = 99;
-
-    // this stage depends on what type of application flow we chosed
-    if (m_graphicMode)
-    {
-        while (true)
-        {
-            // render everything
-            if (!sDrawing->Render())
-                break;
-
-            // each 100 frames, update FPS in window title
-            if (++frames == 100)
-            {
-                core::stringw str = L"Rubik's Cube - KIV/UIR [ ";
-                str += (s32)sDrawing->getDriver()->getFPS();
-                str += L" FPS ]";
-
-                sDrawing->getDevice()->setWindowCaption(str.c_str());
-                frames = 0;
-            }
-        }
-    }
-    else if (!m_quickMode)
-    {
-        // does not run in a loop - retains commands from stdin, etc.
-        sConsole->Run();
-    }
-    else
-    {
-        // also does not run in a loop - just solves input, puts results into file and closes
-        sQuickHandler->Run();
-    }
-
-    return 0;
-}
+#include "Global.h"
+#include "Application.h"
+#include "Drawing.h"
+#include "Console.h"
+#include "Quick.h"
+#include "Generator.h"
+#include "Benchmark.h"
+#include "Converter.h"
+#include "Verifier.h"
+#include "Server.h"
+#include "Rubik.h"
+#include "OpeningBook.h"
+#include "FinalStageTable.h"
+#include "OptimalSolver.h"
+
+#include <ctime>
+
+// set implicit values in this constructor
+Application::Application()
+{
+    m_mode = APP_MODE_GRAPHIC;
+}
+
+Application::~Application()
+{
+    //
+}
+
+// initialize the application with command line args
+bool Application::Init(int argc, char** argv)
+{
+    /*
+        Args:
+                -i file, --input file       - uses file as input (scrambled cube)
+                -o file, --output file      - outputs solution of input cube to this file
+                -ng, --nogui                - runs application without gui
+                -q, --quick                 - if -i and -o are specified, just processes them and exits
+                -ba, --batch                - with -q, solves every cube of input file (nets, facelet strings, permutation strings or scrambles), one solution per line
+                -bo, --binary-output        - with -q and -ba, writes solutions packed in binary format (5 bits per flip)
+                -u, --unpack                - converts packed solutions from input file to text in output file and exits
+                -v file, --verify file      - verifies solutions from file (text or packed) of cubes from input file and exits
+                -sv address, --server address - solves cubes requested over Unix socket (path) or loopback TCP port (number)
+                -s seed, --seed seed        - seeds random generator (to make scrambles reproducible)
+                -g count, --generate count  - generates count of uniformly random states to output file and exits
+                -cd depth, --cache-depth depth - depth of solved side search kept between solves
+                -b count, --benchmark count - solves count of random states and reports solver speed
+                -ob depth, --opening-book depth - depth of opening book (optimal solutions of close positions, 0 = off)
+                -op, --optimal              - finds optimal solutions (Korf's algorithm) instead of Thistlethwaite's
+                -oe count, --optimal-edges count - count of edges in every edge pattern database of optimal solver (6-7)
+                -t count, --threads count   - count of threads used by optimal solver, batch solving, verification and server (0 = one per core)
+    */
+
+    // some nice info
+    cout << "Rubik's Cube solver" << endl;
+    cout << "Semestral work for KIV/UIR subject of University of West Bohemia" << endl;
+    cout << "Author: Martin Ubl (A13B0453P), 2015" << endl;
+    cout << endl;
+
+    std::string infile, outfile, verifyfile, serverAddress;
+    bool nogui = false, quick = false, batch = false, binary = false, unpack = false, optimal = false;
+    bool seedSet = false;
+    unsigned long long seed = 0, generateCount = 0, benchmarkCount = 0;
+    int cacheDepth = BACKWARD_CACHE_DEPTH_DEFAULT;
+    int bookDepth = OPENING_BOOK_DEPTH_DEFAULT;
+    int optimalEdges = OPTIMAL_EDGES_DEFAULT, threads = 0;
+
+    // parse arguments...
+    if (argc > 1)
+    {
+        int cur = 1;
+        while (cur < argc)
+        {
+            if (std::string("-i") == argv[cur] || std::string("--input") == argv[cur])
+            {
+                // load cube configuration
+                if (argc > cur + 1)
+                {
+                    cur++;
+                    infile = argv[cur];
+                }
+            }
+            else if (std::string("-o") == argv[cur] || std::string("--output") == argv[cur])
+            {
+                // store solution to file
+                if (argc > cur + 1)
+                {
+                    cur++;
+                    outfile = argv[cur];
+                }
+            }
+            else if (std::string("-ng") == argv[cur] || std::string("--nogui") == argv[cur])
+            {
+                nogui = true;
+            }
+            else if (std::string("-q") == argv[cur] || std::string("--quick") == argv[cur])
+            {
+                quick = true;
+            }
+            else if (std::string("-ba") == argv[cur] || std::string("--batch") == argv[cur])
+            {
+                batch = true;
+            }
+            else if (std::string("-bo") == argv[cur] || std::string("--binary-output") == argv[cur])
+            {
+                binary = true;
+            }
+            else if (std::string("-u") == argv[cur] || std::string("--unpack") == argv[cur])
+            {
+                unpack = true;
+            }
+            else if (std::string("-v") == argv[cur] || std::string("--verify") == argv[cur])
+            {
+                // verify solutions from file
+                if (argc > cur + 1)
+                {
+                    cur++;
+                    verifyfile = argv[cur];
+                }
+            }
+            else if (std::string("-sv") == argv[cur] || std::string("--server") == argv[cur])
+            {
+                // listen for requests
+                if (argc > cur + 1)
+                {
+                    cur++;
+                    serverAddress = argv[cur];
+                }
+            }
+            else if (std::string("-s") == argv[cur] || std::string("--seed") == argv[cur])
+            {
+                // seed random generator
+                if (argc > cur + 1)
+                {
+                    cur++;
+                    seed = strtoull(argv[cur], nullptr, 10);
+                    seedSet = true;
+                }
+            }
+            else if (std::string("-g") == argv[cur] || std::string("--generate") == argv[cur])
+            {
+                // generate random states
+                if (argc > cur + 1)
+                {
+                    cur++;
+                    generateCount = strtoull(argv[cur], nullptr, 10);
+                }
+            }
+            else if (std::string("-b") == argv[cur] || std::string("--benchmark") == argv[cur])
+            {
+                // solver benchmark
+                if (argc > cur + 1)
+                {
+                    cur++;
+                    benchmarkCount = strtoull(argv[cur], nullptr, 10);
+                }
+            }
+            else if (std::string("-ob") == argv[cur] || std::string("--opening-book") == argv[cur])
+            {
+                // depth of opening book
+                if (argc > cur + 1)
+                {
+                    cur++;
+                    bookDepth = atoi(argv[cur]);
+                }
+            }
+            else if (std::string("-op") == argv[cur] || std::string("--optimal") == argv[cur])
+            {
+                optimal = true;
+            }
+            else if (std::string("-oe") == argv[cur] || std::string("--optimal-edges") == argv[cur])
+            {
+                // count of edges in edge pattern databases
+                if (argc > cur + 1)
+                {
+                    cur++;
+                    optimalEdges = atoi(argv[cur]);
+                }
+            }
+            else if (std::string("-t") == argv[cur] || std::string("--threads") == argv[cur])
+            {
+                // threads of optimal solver, batch solving, verification and server
+                if (argc > cur + 1)
+                {
+                    cur++;
+                    threads = atoi(argv[cur]);
+                }
+            }
+            else if (std::string("-cd") == argv[cur] || std::string("--cache-depth") == argv[cur])
+            {
+                // depth of cached backward search
+                if (argc > cur + 1)
+                {
+                    cur++;
+                    cacheDepth = atoi(argv[cur]);
+                }
+            }
+            else
+            {
+                cerr << "Unrecognized input parameter: " << argv[cur] << endl;
+            }
+
+            cur++;
+        }
+    }
+
+    cout << "Using settings: " << endl;
+    if (infile.length() > 0)
+        cout << "- Input file:  " << infile << endl;
+    if (outfile.length() > 0)
+        cout << "- Output file: " << outfile << endl;
+    if (verifyfile.length() > 0)
+        cout << "- Verify:      " << verifyfile << endl;
+    if (serverAddress.length() > 0)
+        cout << "- Server:      " << serverAddress << endl;
+
+    // when no seed is specified, pick one - but print it anyway, so the run could be reproduced
+    if (!seedSet)
+        seed = (unsigned long long)time(NULL) ^ getUSTime();
+    sRandom->Seed(seed);
+
+    cout << "- GUI:         " << (nogui ? "no" : "yes") << endl;
+    cout << "- Quick:       " << (quick ? "yes" : "no") << endl;
+    if (quick)
+        cout << "- Batch:       " << (batch ? "yes" : "no") << endl;
+    cout << "- Seed:        " << seed << endl;
+    cout << "- Cache depth: " << cacheDepth << endl;
+    cout << "- Book depth:  " << bookDepth << endl;
+    cout << "- Optimal:     " << (optimal ? "yes" : "no") << endl;
+    if (optimal)
+        cout << "- Edge PDBs:   " << optimalEdges << " edges" << endl;
+    // the thread count is shown in every mode, which uses it
+    if (optimal || (quick && batch) || verifyfile.length() > 0 || serverAddress.length() > 0)
+        cout << "- Threads:     " << threads << (threads > 0 ? "" : " (one per core)") << endl;
+    if (generateCount > 0)
+        cout << "- Generate:    " << generateCount << " states" << endl;
+    if (benchmarkCount > 0)
+        cout << "- Benchmark:   " << benchmarkCount << " states" << endl;
+
+    if (quick && batch)
+        cout << "- Binary out:  " << (binary ? "yes" : "no") << endl;
+
+    if (!nogui && (quick || unpack || verifyfile.length() > 0 || serverAddress.length() > 0 || generateCount > 0 || benchmarkCount > 0))
+        cout << "Running without GUI due to " << (quick ? "-q (--quick)" : (unpack ? "-u (--unpack)" : (verifyfile.length() > 0 ? "-v (--verify)" :
+            (serverAddress.length() > 0 ? "-sv (--server)" : (generateCount > 0 ? "-g (--generate)" : "-b (--benchmark)"))))) << " parameter" << endl;
+
+    cout << endl;
+
+    sCube->SetBackwardCacheDepth(cacheDepth);
+
+    if (unpack)
+        m_mode = APP_MODE_CONVERT;
+    else if (verifyfile.length() > 0)
+        m_mode = APP_MODE_VERIFY;
+    else if (serverAddress.length() > 0)
+        m_mode = APP_MODE_SERVER;
+    else if (generateCount > 0)
+        m_mode = APP_MODE_GENERATE;
+    else if (benchmarkCount > 0)
+        m_mode = APP_MODE_BENCHMARK;
+    else if (quick)
+        m_mode = APP_MODE_QUICK;
+    else if (nogui)
+        m_mode = APP_MODE_CONSOLE;
+    else
+        m_mode = APP_MODE_GRAPHIC;
+
+    // generator, converter and verifier do not solve anything, so they need no tables
+    bool solving = (m_mode != APP_MODE_GENERATE && m_mode != APP_MODE_CONVERT && m_mode != APP_MODE_VERIFY);
+
+    // opening book is used everywhere the cube is solved
+    if (solving && bookDepth > 0)
+    {
+        std::string bookFile = std::string(DATA_DIR "openingbook") + std::to_string((long long)bookDepth) + ".bin";
+        if (sOpeningBook->Init(bookDepth, bookFile))
+            cout << "Opening book: " << sOpeningBook->GetCount() << " positions within " << sOpeningBook->GetDepth() << " flips" << endl << endl;
+    }
+
+    // table of the last solving stage is used everywhere the cube is solved as well
+    if (solving)
+        sFinalStageTable->Init(DATA_DIR "finalstage.bin");
+
+    // pattern databases of optimal solver are loaded only when requested, they are quite large
+    if (solving && optimal)
+    {
+        sOptimalSolver->SetThreadCount(threads);
+        if (!sOptimalSolver->Init(optimalEdges, DATA_DIR))
+            return false;
+        sCube->SetOptimal(true);
+        cout << endl;
+    }
+
+    // the tables are mapped (or kept in memory) for the whole run, so it's good to know, how much they take
+    if (solving)
+    {
+        cout << "Table memory:" << endl;
+        if (sOpeningBook->IsLoaded())
+            sOpeningBook->PrintMemoryUsage();
+        if (sFinalStageTable->IsLoaded())
+            sFinalStageTable->PrintMemoryUsage();
+        // the optimal solver builds its move tables on first use, so it's not touched, unless requested
+        if (sCube->IsOptimal() && sOptimalSolver->IsLoaded())
+            sOptimalSolver->PrintMemoryUsage();
+        cout << endl;
+    }
+
+    switch (m_mode)
+    {
+        case APP_MODE_GRAPHIC:
+            // init Irrlicht rendering engine, and init GUI
+            if (!sDrawing->Init())
+                return false;
+            break;
+        case APP_MODE_CONSOLE:
+            // init console gui
+            if (!sConsole->Init())
+                return false;
+            break;
+        case APP_MODE_QUICK:
+            // init quicksolver
+            if (!sQuickHandler->Init(infile, outfile, batch, binary, threads))
+                return false;
+            break;
+        case APP_MODE_GENERATE:
+            // init generator of random states (does not need cube at all)
+            if (!sGenerator->Init(generateCount, outfile))
+                return false;
+            return true;
+        case APP_MODE_BENCHMARK:
+            // init solver benchmark (random states only, input file is not used)
+            if (!sBenchmark->Init(benchmarkCount))
+                return false;
+            return true;
+        case APP_MODE_CONVERT:
+            // init converter of packed solutions (does not need cube either)
+            if (!sConverter->Init(infile, outfile))
+                return false;
+            return true;
+        case APP_MODE_VERIFY:
+            // init verifier of solutions (replays them on cubie level, does not need cube either)
+            if (!sVerifier->Init(infile, verifyfile, threads))
+                return false;
+            return true;
+        case APP_MODE_SERVER:
+            // init solver server (the cubes come with requests, input file is not used)
+            if (!sServer->Init(serverAddress, threads))
+                return false;
+            return true;
+    }
+
+    // load cube if specified input file (batch is read by quick handler itself)
+    if (infile.length() > 0 && !(m_mode == APP_MODE_QUICK && batch))
+    {
+        // quick mode has nothing to do without valid input
+        if (!sCube->LoadFromFile((char*)infile.c_str()) && m_mode == APP_MODE_QUICK)
+            return false;
+    }
+
+    return true;
+}
+
+int Application::Run()
+{
+    int frames = 99;
+
+    // this stage depends on what type of application flow we chosed
+    switch (m_mode)
+    {
+        case APP_MODE_GRAPHIC:
+        {
+            while (true)
+            {
+                // render everything
+                if (!sDrawing->Render())
+                    break;
+
+                // each 100 frames, update FPS in window title
+                if (++frames == 100)
+                {
+                    core::stringw str = L"Rubik's Cube - KIV/UIR [ ";
+                    str += (s32)sDrawing->getDriver()->getFPS();
+                    str += L" FPS ]";
+
+                    sDrawing->getDevice()->setWindowCaption(str.c_str());
+                    frames = 0;
+                }
+            }
+            break;
+        }
+        case APP_MODE_CONSOLE:
+            // does not run in a loop - retains commands from stdin, etc.
+            sConsole->Run();
+            break;
+        case APP_MODE_QUICK:
+            // also does not run in a loop - just solves input, puts results into file and closes
+            sQuickHandler->Run();
+            break;
+        case APP_MODE_GENERATE:
+            // generates states to file and closes
+            sGenerator->Run();
+            break;
+        case APP_MODE_BENCHMARK:
+            // solves random states, reports and closes
+            sBenchmark->Run();
+            break;
+        case APP_MODE_CONVERT:
+            // converts packed solutions to text and closes
+            sConverter->Run();
+            break;
+        case APP_MODE_VERIFY:
+            // verifies solutions, reports and closes
+            sVerifier->Run();
+            break;
+        case APP_MODE_SERVER:
+            // solves requests until interrupted, then closes
+            sServer->Run();
+            break;
+    }
+
+    return 0;
+}
@@ -1,27 +1,39 @@
-#ifndef RUBIK_APPLICATION_H
-#define RUBIK_APPLICATION_H
-
-#include "Singleton.h"
-
-class Application
-{
-    friend class Singleton<Application>;
-
-    public:
-        ~Application();
-
-        bool Init(int argc, char** argv);
-        int Run();
-
-        bool IsGraphicMode() { return m_graphicMode; };
-
-    private:
-        Application();
-
-        bool m_graphicMode;
-        bool m_quickMode;
-};
-
-#define sApplication Singleton<Application>::instance()
-
-#endif
+#ifndef RUBIK_APPLICATION_H
+#define RUBIK_APPLICATION_H
+
+#include "Singleton.h"
+
+// application flow type, chosen by command line arguments
+enum ApplicationMode
+{
+    APP_MODE_GRAPHIC = 0,   // GUI
+    APP_MODE_CONSOLE = 1,   // console interface (nogui)
+    APP_MODE_QUICK = 2,     // just solves input file and exits
+    APP_MODE_GENERATE = 3,  // generates random states to file and exits
+    APP_MODE_BENCHMARK = 4, // measures solver speed and exits
+    APP_MODE_CONVERT = 5,   // converts packed solutions to text and exits
+    APP_MODE_VERIFY = 6,    // verifies solutions of input cubes and exits
+    APP_MODE_SERVER = 7,    // solves cubes requested over local socket until interrupted
+};
+
+class Application
+{
+    friend class Singleton<Application>;
+
+    public:
+        ~Application();
+
+        bool Init(int argc, char** argv);
+        int Run();
+
+        bool IsGraphicMode() { return m_mode == APP_MODE_GRAPHIC; };
+
+    private:
+        Application();
+
+        ApplicationMode m_mode;
+};
+
+#define sApplication Singleton<Application>::instance()
+
+#endif
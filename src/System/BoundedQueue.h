@@ -0,0 +1,61 @@
+#ifndef RUBIK_BOUNDEDQUEUE_H
+#define RUBIK_BOUNDEDQUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+// queue between two stages of pipeline (running in different threads) with limited capacity - the producer waits,
+// while the queue is full, so the faster stage could not run away from the slower one; when the producer is done,
+// it closes the queue, and the consumers drain what's left
+template <class T>
+class BoundedQueue
+{
+    public:
+        BoundedQueue(size_t capacity) : m_capacity(capacity), m_closed(false) { }
+
+        // appends item to queue, waits while the queue is full
+        void Push(T const& item)
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_notFull.wait(lock, [this]() { return m_items.size() < m_capacity; });
+
+            m_items.push_back(item);
+            m_notEmpty.notify_one();
+        }
+
+        // retrieves the oldest item, waits while the queue is empty; returns false, when the queue is closed and
+        // there's nothing left
+        bool Pop(T &item)
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_notEmpty.wait(lock, [this]() { return !m_items.empty() || m_closed; });
+
+            if (m_items.empty())
+                return false;
+
+            item = m_items.front();
+            m_items.pop_front();
+            m_notFull.notify_one();
+
+            return true;
+        }
+
+        // marks the end of items (no more items will be pushed)
+        void Close()
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_closed = true;
+            m_notEmpty.notify_all();
+        }
+
+    private:
+        std::deque<T> m_items;
+        size_t m_capacity;
+        bool m_closed;
+
+        std::mutex m_lock;
+        std::condition_variable m_notFull, m_notEmpty;
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef RUBIK_DEADLINEQUEUE_H
+#define RUBIK_DEADLINEQUEUE_H
+
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+
+// queue of requests waiting for workers with limited capacity - the items are retrieved by priority (higher first),
+// then by deadline (earliest first, items without deadline last), then in order of arrival; unlike BoundedQueue,
+// the producer never waits - when the queue is full, the item is refused, so it could be rejected right away
+template <class T>
+class DeadlineQueue
+{
+    public:
+        DeadlineQueue(size_t capacity) : m_capacity(capacity), m_closed(false), m_sequence(0) { }
+
+        // appends item with priority and deadline (see getUSTime, 0 = no deadline); returns false, when the queue
+        // is full or closed
+        bool TryPush(T const& item, int priority, unsigned long long deadline)
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            if (m_closed || m_items.size() >= m_capacity)
+                return false;
+
+            Entry entry;
+            entry.item = item;
+            entry.priority = priority;
+            entry.deadline = deadline ? deadline : ~0ULL;
+            entry.sequence = m_sequence++;
+            m_items.push(entry);
+
+            m_notEmpty.notify_one();
+            return true;
+        }
+
+        // retrieves the most urgent item, waits while the queue is empty; returns false, when the queue is closed
+        // and there's nothing left
+        bool Pop(T &item)
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_notEmpty.wait(lock, [this]() { return !m_items.empty() || m_closed; });
+
+            if (m_items.empty())
+                return false;
+
+            item = m_items.top().item;
+            m_items.pop();
+            return true;
+        }
+
+        // no more items will be pushed - wakes up all waiting consumers
+        void Close()
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_closed = true;
+            m_notEmpty.notify_all();
+        }
+
+    private:
+        struct Entry
+        {
+            T item;
+            int priority;
+            unsigned long long deadline;
+            unsigned long long sequence;
+        };
+
+        // the top of priority queue is the "largest" entry, so the less urgent entry is the "smaller" one
+        struct EntryOrder
+        {
+            bool operator()(Entry const& a, Entry const& b) const
+            {
+                if (a.priority != b.priority)
+                    return a.priority < b.priority;
+                if (a.deadline != b.deadline)
+                    return a.deadline > b.deadline;
+                return a.sequence > b.sequence;
+            }
+        };
+
+        std::priority_queue<Entry, std::vector<Entry>, EntryOrder> m_items;
+        size_t m_capacity;
+        bool m_closed;
+        // count of items pushed so far (keeps order of arrival among equal items)
+        unsigned long long m_sequence;
+
+        std::mutex m_lock;
+        std::condition_variable m_notEmpty;
+};
+
+#endif
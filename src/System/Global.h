@@ -1,55 +1,75 @@
-#ifndef RUBIK_GLOBAL_H
-#define RUBIK_GLOBAL_H
-
-#include <iostream>
-#include <list>
-#include <vector>
-#include <map>
-#include <string>
-#include <algorithm>
-#include <irrlicht.h>
-
-using namespace std;
-
-using namespace irr;
-
-using namespace core;
-using namespace scene;
-using namespace video;
-using namespace io;
-using namespace gui;
-
-#ifdef _IRR_WINDOWS_
-#pragma comment(lib, "Irrlicht.lib")
-//#pragma comment(linker, "/subsystem:windows /ENTRY:mainCRTStartup")
-#endif
-
-#ifdef _DEBUG
-#define DATA_DIR "../data/"
-#else
-#define DATA_DIR "./data/"
-#endif
-
-#ifdef _WIN32
-#include <Windows.h>
-inline unsigned int getMSTime() { return GetTickCount(); }
-#else
-inline uint32 getMSTime()
-{
-    struct timeval tv;
-    struct timezone tz;
-    gettimeofday(&tv, &tz);
-    return (tv.tv_sec * 1000) + (tv.tv_usec / 1000);
-}
-#endif
-
-inline unsigned int getMSTimeDiff(unsigned int oldMSTime, unsigned int newMSTime)
-{
-    // getMSTime() have limited data range and this is case when it overflow in this tick
-    if (oldMSTime > newMSTime)
-        return (0xFFFFFFFF - oldMSTime) + newMSTime;
-    else
-        return newMSTime - oldMSTime;
-}
-
-#endif
+#ifndef RUBIK_GLOBAL_H
+#define RUBIK_GLOBAL_H
+
+#include <iostream>
+#include <list>
+#include <vector>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <irrlicht.h>
+
+using namespace std;
+
+using namespace irr;
+
+using namespace core;
+using namespace scene;
+using namespace video;
+using namespace io;
+using namespace gui;
+
+#ifdef _IRR_WINDOWS_
+#pragma comment(lib, "Irrlicht.lib")
+//#pragma comment(linker, "/subsystem:windows /ENTRY:mainCRTStartup")
+#endif
+
+#ifdef _DEBUG
+#define DATA_DIR "../data/"
+#else
+#define DATA_DIR "./data/"
+#endif
+
+#ifdef _WIN32
+#include <Windows.h>
+inline unsigned int getMSTime() { return GetTickCount(); }
+
+// monotonic high resolution time in microseconds (does not wrap in any reasonable time)
+inline unsigned long long getUSTime()
+{
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    // split to avoid overflow of multiplication on high frequency counters
+    return (now.QuadPart / freq.QuadPart) * 1000000ULL + ((now.QuadPart % freq.QuadPart) * 1000000ULL) / freq.QuadPart;
+}
+#else
+#include <sys/time.h>
+#include <time.h>
+inline uint32 getMSTime()
+{
+    struct timeval tv;
+    struct timezone tz;
+    gettimeofday(&tv, &tz);
+    return (tv.tv_sec * 1000) + (tv.tv_usec / 1000);
+}
+
+// monotonic high resolution time in microseconds (does not wrap in any reasonable time)
+inline unsigned long long getUSTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+#endif
+
+inline unsigned int getMSTimeDiff(unsigned int oldMSTime, unsigned int newMSTime)
+{
+    // getMSTime() have limited data range and this is case when it overflow in this tick
+    if (oldMSTime > newMSTime)
+        return (0xFFFFFFFF - oldMSTime) + newMSTime;
+    else
+        return newMSTime - oldMSTime;
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef RUBIK_MAPPEDFILE_H
+#define RUBIK_MAPPEDFILE_H
+
+#include <stddef.h>
+
+// read-only memory mapped file - the contents are loaded by operating system on demand, and shared between
+// processes mapping the same file
+class MappedFile
+{
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        // maps whole file to memory; returns false, if the file could not be opened or mapped
+        bool Open(const char* filename);
+        // unmaps file
+        void Close();
+        // hints the system, that the file will be read from start to end (so it could read ahead)
+        void AdviseSequential();
+
+        // is the file mapped?
+        bool IsOpen() const { return m_data != nullptr; };
+        // retrieves contents of file
+        const char* GetData() const { return m_data; };
+        // retrieves size of file
+        size_t GetSize() const { return m_size; };
+
+    private:
+        // no copies - the mapping is owned by this instance
+        MappedFile(MappedFile const&);
+        MappedFile& operator=(MappedFile const&);
+
+        // mapped contents
+        const char* m_data;
+        // size of contents
+        size_t m_size;
+
+#ifdef _WIN32
+        // handles of file and its mapping
+        void* m_file;
+        void* m_mapping;
+#else
+        // file descriptor
+        int m_fd;
+#endif
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef RUBIK_RANDOM_H
+#define RUBIK_RANDOM_H
+
+#include "Singleton.h"
+
+// fast seedable pseudo-random generator (xoshiro256**, see http://prng.di.unimi.it/); the state is seeded using
+// splitmix64 generator, so even similar seeds (0, 1, 2, ..) produce unrelated sequences
+class Random
+{
+    public:
+        Random()
+        {
+            Seed(0);
+        }
+
+        Random(unsigned long long seed)
+        {
+            Seed(seed);
+        }
+
+        // seeds the generator - the same seed always produces the same sequence
+        void Seed(unsigned long long seed)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                seed += 0x9E3779B97F4A7C15ULL;
+                unsigned long long z = seed;
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                m_state[i] = z ^ (z >> 31);
+            }
+        }
+
+        // retrieves next 64 random bits
+        unsigned long long Next()
+        {
+            unsigned long long result = rotl(m_state[1] * 5, 7) * 9;
+            unsigned long long t = m_state[1] << 17;
+
+            m_state[2] ^= m_state[0];
+            m_state[3] ^= m_state[1];
+            m_state[1] ^= m_state[2];
+            m_state[0] ^= m_state[3];
+            m_state[2] ^= t;
+            m_state[3] = rotl(m_state[3], 45);
+
+            return result;
+        }
+
+        // retrieves uniformly distributed random number from range 0 to bound-1 (without modulo bias)
+        unsigned int NextUInt(unsigned int bound)
+        {
+            // multiply-shift method; reject the few values, which would make some results more probable
+            unsigned long long m = (Next() >> 32) * bound;
+            if ((unsigned int)m < bound)
+            {
+                unsigned int threshold = (0u - bound) % bound;
+                while ((unsigned int)m < threshold)
+                    m = (Next() >> 32) * bound;
+            }
+            return (unsigned int)(m >> 32);
+        }
+
+    private:
+        static unsigned long long rotl(unsigned long long x, int k)
+        {
+            return (x << k) | (x >> (64 - k));
+        }
+
+        unsigned long long m_state[4];
+};
+
+// application-wide generator (seeded in Application::Init)
+#define sRandom Singleton<Random>::instance()
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef RUBIK_SPSCQUEUE_H
+#define RUBIK_SPSCQUEUE_H
+
+#include <vector>
+#include <atomic>
+
+// lock-free queue between exactly one producer thread and exactly one consumer thread - ring buffer of fixed
+// capacity, the producer moves its tail, the consumer moves its head, and neither of them ever waits or locks; it's
+// meant for threads, which must not block (like the render loop), so the caller decides what to do, when the queue
+// is full or empty
+template <class T>
+class SpscQueue
+{
+    public:
+        // one slot is always kept free to tell full ring from empty one
+        SpscQueue(size_t capacity) : m_slots(capacity + 1), m_head(0), m_tail(0) { }
+
+        // appends item (producer only); returns false, when the queue is full
+        bool TryPush(T const& item)
+        {
+            size_t tail = m_tail.load(std::memory_order_relaxed);
+            size_t next = (tail + 1) % m_slots.size();
+            if (next == m_head.load(std::memory_order_acquire))
+                return false;
+
+            m_slots[tail] = item;
+            m_tail.store(next, std::memory_order_release);
+            return true;
+        }
+
+        // retrieves the oldest item (consumer only); returns false, when the queue is empty
+        bool TryPop(T &item)
+        {
+            size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_tail.load(std::memory_order_acquire))
+                return false;
+
+            item = m_slots[head];
+            m_head.store((head + 1) % m_slots.size(), std::memory_order_release);
+            return true;
+        }
+
+    private:
+        std::vector<T> m_slots;
+        // index of the oldest item (moved by consumer), and of the first free slot (moved by producer); they are
+        // kept apart, so the two threads do not share cache line
+        std::atomic<size_t> m_head;
+        char m_padding[64];
+        std::atomic<size_t> m_tail;
+};
+
+#endif